@@ -0,0 +1,55 @@
+/*
+ * BAND AGGREGATOR FOR THE THERMAL PRINTER
+ */
+
+#include "BandAggregator.h"
+
+BandAggregator::BandAggregator()
+{
+  setup(16, 1500);
+}
+
+void BandAggregator::setup(int _numRows, int _windowMillis) {
+  numRows = max(_numRows, 1);
+  windowMillis = _windowMillis;
+  clear();
+}
+
+//a row of another width can not go in the same raster, the band has to be printed first
+bool BandAggregator::fits(const vector<int>& _shed) {
+  return rows == 0 || (int)_shed.size() == numWarps;
+}
+
+//ADDS A ROW, true when the band is full and should be printed. a row that does not
+//fit is not added and the rows already in the band are kept
+bool BandAggregator::add(const vector<int>& _shed) {
+  if (!fits(_shed)) {
+    ofLogWarning("BandAggregator") << "row of " << _shed.size() << " warps does not fit a band of " << numWarps << ", not added";
+    return true;
+  }
+  if (rows == 0) {
+    numWarps = (int)_shed.size();
+    firstRowMillis = ofGetElapsedTimeMillis();
+    cells.reserve(numRows * numWarps);
+  }
+
+  cells.insert(cells.end(), _shed.begin(), _shed.end());
+  rows++;
+  return rows >= numRows;
+}
+
+//true when there is something waiting for longer than the time window
+bool BandAggregator::isDue() {
+  return rows > 0 && ofGetElapsedTimeMillis() - firstRowMillis >= (uint64_t)windowMillis;
+}
+
+bool BandAggregator::isEmpty() {
+  return rows == 0;
+}
+
+void BandAggregator::clear() {
+  cells.clear();
+  rows = 0;
+  numWarps = 0;
+  firstRowMillis = 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * BAND AGGREGATOR FOR THE THERMAL PRINTER
+ *
+ * collects consecutive sheds into a band, a block of rows that goes to the printer
+ * as one job and one raster command instead of one job per 7 dot high strip.
+ * a band is done when it has numRows rows or when its first row is older than
+ * windowMillis, and it can be flushed at any time (session switch, exit).
+ * all rows of a band have the same width, a row of another width needs the band
+ * printed before it (fits tells), the rows collected are never thrown away.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class BandAggregator {
+
+public:
+    BandAggregator();
+
+    void setup(int _numRows, int _windowMillis);
+    bool fits(const vector<int>& _shed);
+    bool add(const vector<int>& _shed);
+    bool isDue();
+    bool isEmpty();
+    void clear();
+
+    int numRows, windowMillis;
+    int numWarps, rows;
+    vector<int> cells; //the rows of the band one after the other
+    uint64_t firstRowMillis;
+};
@@ -0,0 +1,389 @@
+/*
+ * BENCHMARKS
+ */
+
+#include "Bench.h"
+#include "EntSystem.h"
+#include "ThreadedCV.h"
+#include "FlowZones.h"
+#include "GrayFrame.h"
+#include "MotionGate.h"
+
+//--------------------------------------------------------------
+//same cell size as the app, grids from the app size up to 16 times as wide
+void benchEntSystem(int _numEnts, int _millisPerSize) {
+  float sz = 8;
+  cout << "ent system, " << _numEnts << " ents" << endl;
+  cout << "cols x rows      cells    ticks/s   ent steps/s   flip us    bytes" << endl;
+
+  for (int numCols = 100; numCols <= 1600; numCols *= 2) {
+    int numRows = numCols * 6 / 10;
+    EntSystem ents;
+    ents.useGL = false;
+    ents.setup(numCols, sz, _numEnts, 0, 0, numCols * sz, numRows * sz);
+    ents.morph = false;
+
+    uint64_t ticks = 0;
+    uint64_t start = ofGetElapsedTimeMicros();
+    uint64_t end = start + _millisPerSize * 1000;
+    uint64_t now = start;
+    while (now < end) {
+      //in batches so the clock is not read every tick
+      for (int i = 0; i < 64; i++) {
+        ents.update(0);
+      }
+      ticks += 64;
+      now = ofGetElapsedTimeMicros();
+    }
+    double seconds = (now - start) / 1000000.0;
+
+    //whole grid flip, word at a time
+    uint64_t flipStart = ofGetElapsedTimeMicros();
+    for (int i = 0; i < 100; i++) {
+      ents.totalCellFlip();
+    }
+    double flipMicros = (ofGetElapsedTimeMicros() - flipStart) / 100.0;
+    size_t bytes = ents.cells.size() * sizeof(uint64_t);
+
+    char line[128];
+    snprintf(line, sizeof(line), "%4d x %-4d %10d %10.0f %13.0f %9.1f %8zu", numCols, numRows, numCols * numRows,
+             ticks / seconds, ticks * _numEnts / seconds, flipMicros, bytes);
+    cout << line << endl;
+  }
+}
+
+//--------------------------------------------------------------
+//same seed for every run, the grid after the ticks has to be the same as with 1 thread
+void benchEntParallel(int _numEnts, int _numCols, int _numTicks) {
+  float sz = 8;
+  int numRows = _numCols * 6 / 10;
+  int maxThreads = max((int)std::thread::hardware_concurrency(), 1);
+  cout << "ent system parallel, " << _numEnts << " ents, " << _numCols << " x " << numRows << ", " << _numTicks << " ticks" << endl;
+  cout << "threads    ticks/s   speedup  same" << endl;
+
+  double serialRate = 0;
+  vector<uint64_t> serialCells;
+  for (int t = 1; t <= maxThreads; t = t < maxThreads && t * 2 > maxThreads ? maxThreads : t * 2) {
+    ofSeedRandom(7777);
+    EntSystem ents;
+    ents.useGL = false;
+    ents.setup(_numCols, sz, _numEnts, 0, 0, _numCols * sz, numRows * sz);
+    ents.morph = false;
+    ents.setThreads(t);
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    for (int i = 0; i < _numTicks; i++) {
+      ents.update(0);
+    }
+    double rate = _numTicks / ((ofGetElapsedTimeMicros() - start) / 1000000.0);
+    if (t == 1) {
+      serialRate = rate;
+      serialCells = ents.cells;
+    }
+
+    char line[128];
+    snprintf(line, sizeof(line), "%7d %10.0f %9.2f  %s", t, rate, rate / serialRate, ents.cells == serialCells ? "yes" : "NO");
+    cout << line << endl;
+    if (t == maxThreads) {
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------
+//few ents on a small grid fall into a repeat early, many ents may never do. an ent
+//on a highway repeats shifted, unbounded it never stops
+void benchEntCycles(int _numEnts, int _numCols, uint64_t _numTicks, bool _unbounded) {
+  float sz = 8;
+  int numRows = _numCols * 6 / 10;
+  cout << "ent system cycles, " << _numEnts << " ents, " << _numCols << " x " << numRows << (_unbounded ? " unbounded, " : ", ")
+       << _numTicks << " ticks" << endl;
+
+  EntSystem runs[2];
+  double millis[2];
+  for (int r = 0; r < 2; r++) {
+    ofSeedRandom(7777);
+    runs[r].useGL = false;
+    runs[r].unbounded = _unbounded;
+    runs[r].setup(_numCols, sz, _numEnts, 0, 0, _numCols * sz, numRows * sz);
+    runs[r].morph = false;
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    if (r == 0) {
+      for (uint64_t i = 0; i < _numTicks; i++) {
+        runs[r].update(0);
+      }
+    } else {
+      runs[r].fastForward(_numTicks);
+    }
+    millis[r] = (ofGetElapsedTimeMicros() - start) / 1000.0;
+  }
+
+  EntSystem& ff = runs[1];
+  bool same = (_unbounded ? runs[0].world.same(ff.world) : runs[0].cells == ff.cells) && runs[0].states == ff.states;
+  for (int i = 0; same && i < _numEnts; i++) {
+    same = runs[0].entArr[i].col == ff.entArr[i].col && runs[0].entArr[i].row == ff.entArr[i].row && runs[0].entArr[i].dir == ff.entArr[i].dir;
+  }
+  char line[200];
+  snprintf(line, sizeof(line), "stepped %9.1f ms, fast forward %9.1f ms, period %llu shifted %d,%d from tick %llu, %llu ticks skipped, same %s",
+           millis[0], millis[1], (unsigned long long)ff.cyclePeriod, ff.shiftCol, ff.shiftRow, (unsigned long long)ff.checkTick,
+           (unsigned long long)ff.ticksSkipped, same ? "yes" : "NO");
+  cout << line << endl;
+}
+
+//--------------------------------------------------------------
+//the same ents bounded and unbounded, memory is what the ents visited
+void benchEntWorld(int _numEnts, int _numTicks) {
+  float sz = 8;
+  cout << "ent world, " << _numEnts << " ents, " << _numTicks << " ticks" << endl;
+  for (int u = 0; u < 2; u++) {
+    ofSeedRandom(7777);
+    EntSystem ents;
+    ents.useGL = false;
+    ents.unbounded = u == 1;
+    ents.setup(100, sz, _numEnts, 0, 0, 100 * sz, 60 * sz);
+    ents.morph = false;
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    ents.stepN(_numTicks);
+    double rate = _numTicks / ((ofGetElapsedTimeMicros() - start) / 1000000.0);
+
+    char line[160];
+    if (u == 0) {
+      snprintf(line, sizeof(line), "bounded   %10.0f ticks/s, %zu bytes", rate, ents.cells.size() * sizeof(uint64_t));
+    } else {
+      snprintf(line, sizeof(line), "unbounded %10.0f ticks/s, ", rate);
+    }
+    cout << line << (u == 1 ? ents.world.getStats() : "") << endl;
+  }
+}
+
+//--------------------------------------------------------------
+//the whole vision pipeline on its own thread, fed blobs without waiting for a camera,
+//once with every flow backend
+void benchCV(int _numFrames) {
+  cout << "vision, synthetic blobs, " << _numFrames << " frames" << endl;
+  cout << "backend       frames/s  x camera  ms/frame  ms flow  cursor   flow x   flow y   want x   want y" << endl;
+  for (int b = 0; ; b++) {
+    ThreadedCV vision;
+    if (b >= vision.backends.size()) {
+      break;
+    }
+    vision.setBackend(b);
+    vision.setSource(unique_ptr<FrameSource>(new SyntheticSource()));
+    vision.source->realtime = false;
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    vision.setup(5, 50);
+    while (vision.framesProcessed < (uint64_t)_numFrames) {
+      ofSleepMillis(5);
+    }
+    double seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+    vision.stop();
+    vision.update();
+    const CVResult& r = vision.getResult();
+
+    //the flow of the last frame against what the blobs moved, in pixels of the
+    //decimated and mirrored image. blob edges and overlaps are not counted exactly,
+    //within half of the expected length is ok
+    glm::vec2 got = vision.flowZones.average;
+    glm::vec2 want = static_cast<SyntheticSource*>(vision.source.get())->getMeanFlow() / (float)vision.grayFrame.factor;
+    if (vision.grayFrame.mirror) {
+      want.x = -want.x;
+    }
+    float error = glm::length(got - want) / max(glm::length(want), 0.05f);
+
+    char line[200];
+    snprintf(line, sizeof(line), "%-12s %9.1f %9.1f %9.2f %8.2f %7d %8.3f %8.3f %8.3f %8.3f %s", vision.backends[b]->getName().c_str(),
+             vision.framesProcessed / seconds, vision.framesProcessed / seconds / vision.frameRate,
+             vision.frameMicros / 1000.0, vision.backends[b]->avgMicros / 1000.0, (int)r.cursorX, got.x, got.y,
+             want.x, want.y, error < 0.5 ? "ok" : "OFF");
+    cout << line << endl;
+  }
+}
+
+//--------------------------------------------------------------
+//a field the size of the decimated camera image, every zone moving its own way.
+//the reduction is all the vision thread runs on a field, it gives the flow and the
+//zones. against the plain average loop the backends ran before the zones, it should
+//cost about the same and come to the same average
+void benchFlowZones(int _numZones, int _numFields) {
+  int w = 160;
+  int h = 120;
+  cv::Mat field(h, w, CV_32FC2);
+  FlowZones zones;
+  zones.setup(_numZones);
+  for (int y = 0; y < h; y++) {
+    cv::Vec2f* row = field.ptr<cv::Vec2f>(y);
+    for (int x = 0; x < w; x++) {
+      float a = (x * _numZones / w) * TWO_PI / _numZones;
+      row[x][0] = cos(a) + ofRandom(-0.1, 0.1);
+      row[x][1] = sin(a) + ofRandom(-0.1, 0.1);
+    }
+  }
+
+  uint64_t start = ofGetElapsedTimeMicros();
+  glm::vec2 avg;
+  for (int i = 0; i < _numFields; i++) {
+    double sx = 0;
+    double sy = 0;
+    for (int y = 0; y < h; y++) {
+      const cv::Vec2f* row = field.ptr<cv::Vec2f>(y);
+      for (int x = 0; x < w; x++) {
+        sx += row[x][0];
+        sy += row[x][1];
+      }
+    }
+    avg = glm::vec2(sx, sy) / (float)(w * h);
+  }
+  double avgMicros = (double)(ofGetElapsedTimeMicros() - start) / _numFields;
+
+  start = ofGetElapsedTimeMicros();
+  for (int i = 0; i < _numFields; i++) {
+    zones.reduce(field);
+  }
+  double zoneMicros = (double)(ofGetElapsedTimeMicros() - start) / _numFields;
+
+  char line[200];
+  snprintf(line, sizeof(line), "flow zones, %dx%d field, %d zones: plain average %.1f us, zones %.1f us (x%.2f), average %.3f %.3f / %.3f %.3f",
+           w, h, _numZones, avgMicros, zoneMicros, zoneMicros / max(avgMicros, 0.001), avg.x, avg.y, zones.average.x, zones.average.y);
+  cout << line << endl;
+  cout << "zone   mean x   mean y    speed  main direction" << endl;
+  for (int i = 0; i < _numZones; i++) {
+    const FlowZone& z = zones.zones[i];
+    int main = max_element(z.hist, z.hist + 8) - z.hist;
+    snprintf(line, sizeof(line), "%4d %8.3f %8.3f %8.3f  %d (%.0f%%)", i, z.mean.x, z.mean.y, z.magnitude, main, z.hist[main] * 100);
+    cout << line << endl;
+  }
+}
+
+//--------------------------------------------------------------
+//the gray frame for the flow in one pass against the opencv steps it replaced: an
+//area resize, a mirror and a gray conversion. the blobs get a different value in
+//every channel so the weights of the channels are tested too. both round on the
+//way, a difference of 1 is allowed
+void benchGrayFrame(int _numFrames) {
+  SyntheticSource source;
+  source.realtime = false;
+  source.setup(640, 480, 60);
+  int f = 4;
+  int w = 640 / f;
+  int h = 480 / f;
+  GrayFrame fused;
+  fused.setup(f, true);
+  ofPixels frame;
+  frame.allocate(640, 480, OF_PIXELS_RGB);
+  cv::Mat small, mirrored, gray;
+
+  uint64_t fusedMicros = 0;
+  uint64_t stepsMicros = 0;
+  int maxDiff = 0;
+  for (int i = 0; i < _numFrames; i++) {
+    source.update();
+    const unsigned char* src = source.getPixels().getData();
+    unsigned char* dst = frame.getData();
+    for (int y = 0; y < 480; y++) {
+      for (int x = 0; x < 640; x++) {
+        int p = (y * 640 + x) * 3;
+        dst[p] = src[p];
+        dst[p + 1] = (src[p] * 3 + x) & 255;
+        dst[p + 2] = (255 - src[p] + y) & 255;
+      }
+    }
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    fused.update(frame);
+    fusedMicros += ofGetElapsedTimeMicros() - start;
+
+    start = ofGetElapsedTimeMicros();
+    cv::resize(ofxCv::toCv(frame), small, cv::Size(w, h), 0, 0, cv::INTER_AREA);
+    cv::flip(small, mirrored, 1);
+    cv::cvtColor(mirrored, gray, cv::COLOR_RGB2GRAY);
+    stepsMicros += ofGetElapsedTimeMicros() - start;
+
+    if (gray.rows != h || gray.cols != w) {
+      maxDiff = 255;
+      continue;
+    }
+    for (int y = 0; y < h; y++) {
+      const unsigned char* want = gray.ptr<unsigned char>(y);
+      const unsigned char* got = fused.gray.ptr<unsigned char>(y);
+      for (int x = 0; x < w; x++) {
+        maxDiff = max(maxDiff, abs(got[x] - want[x]));
+      }
+    }
+  }
+
+  //bytes read and written per frame, the steps write the small colour image, its mirror and read them again
+  size_t frameBytes = 640 * 480 * 3;
+  size_t fusedBytes = frameBytes + w * h;
+  size_t stepsBytes = frameBytes + w * h * 3 * 4 + w * h;
+  char line[200];
+  snprintf(line, sizeof(line), "gray frame, 640x480 to %dx%d: one pass %.1f us %zu KB, opencv %.1f us %zu KB, largest difference %d %s",
+           w, h, (double)fusedMicros / _numFrames, fusedBytes / 1024, (double)stepsMicros / _numFrames, stepsBytes / 1024, maxDiff,
+           maxDiff <= 1 ? "ok" : "TOO LARGE");
+  cout << line << endl;
+}
+
+//--------------------------------------------------------------
+//the difference sum with simd against plain c, then the vision on a still scene
+//and on moving blobs, with and without the gate
+void benchMotionGate(int _numFrames) {
+  SyntheticSource blobs;
+  blobs.realtime = false;
+  blobs.setup(640, 480, 60);
+  GrayFrame a, b;
+  a.update(blobs.getPixels());
+  blobs.update();
+  b.update(blobs.getPixels());
+  size_t n = a.pixels.size();
+
+  uint64_t simd = 0;
+  uint64_t scalar = 0;
+  uint64_t start = ofGetElapsedTimeMicros();
+  for (int i = 0; i < 1000; i++) {
+    simd += MotionGate::sad(a.pixels.getData(), b.pixels.getData(), n);
+  }
+  double simdMicros = (ofGetElapsedTimeMicros() - start) / 1000.0;
+  start = ofGetElapsedTimeMicros();
+  for (int i = 0; i < 1000; i++) {
+    scalar += MotionGate::sadScalar(a.pixels.getData(), b.pixels.getData(), n);
+  }
+  double scalarMicros = (ofGetElapsedTimeMicros() - start) / 1000.0;
+
+  char line[200];
+  snprintf(line, sizeof(line), "motion gate, sad of %zu pixels: simd %.2f us, plain %.2f us, same %s", n, simdMicros, scalarMicros,
+           simd == scalar ? "yes" : "NO");
+  cout << line << endl;
+
+  cout << "scene    gate  ms/frame  skipped" << endl;
+  for (int run = 0; run < 4; run++) {
+    bool still = run < 2;
+    ThreadedCV vision;
+    vision.setSource(unique_ptr<FrameSource>(new SyntheticSource(still ? 0 : 3)));
+    vision.source->realtime = false;
+    vision.gate.enabled = run % 2 == 1;
+    vision.setup(5, 50);
+    while (vision.framesProcessed < (uint64_t)_numFrames) {
+      ofSleepMillis(5);
+    }
+    vision.stop();
+    snprintf(line, sizeof(line), "%-8s %-5s %8.2f %7.0f%%", still ? "still" : "moving", vision.gate.enabled ? "on" : "off",
+             vision.frameMicros / 1000.0, 100.0 * vision.gate.framesSkipped / max(vision.framesProcessed.load(), (uint64_t)1));
+    cout << line << endl;
+  }
+}
+
+//--------------------------------------------------------------
+void runBenchmarks(int _numShafts) {
+  benchEntSystem(_numShafts, 200);
+  benchEntSystem(1000, 200);
+  benchEntParallel(20000, 1600, 500);
+  benchEntCycles(1, 100, 10000000, false);
+  benchEntCycles(1, 100, 1000000, true);
+  benchEntWorld(_numShafts, 1000000);
+  benchCV(300);
+  benchFlowZones(_numShafts, 1000);
+  benchGrayFrame(300);
+  benchMotionGate(300);
+}
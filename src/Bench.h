@@ -0,0 +1,37 @@
+/*
+ * BENCHMARKS
+ *
+ * run from the app with a key or with --bench, results are printed to the console.
+ * they block the main thread while running, about a second each.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+//steps per second of the ent system as the grid grows
+void benchEntSystem(int _numEnts, int _millisPerSize);
+
+//ticks per second of the parallel step from 1 to all cores, checked against the serial result
+void benchEntParallel(int _numEnts, int _numCols, int _numTicks);
+
+//a long run stepped and fast forwarded over repeats, in place or shifted, checked against each other
+void benchEntCycles(int _numEnts, int _numCols, uint64_t _numTicks, bool _unbounded);
+
+//ticks per second and memory of an unbounded world as the ents wander off
+void benchEntWorld(int _numEnts, int _numTicks);
+
+//frames per second of the vision on synthetic blobs, as fast as it goes, and the flow found against the blobs
+void benchCV(int _numFrames);
+
+//the per zone reduction the vision runs on every flow field against a plain average of it
+void benchFlowZones(int _numZones, int _numFields);
+
+//the decimated mirrored gray frame in one pass against opencv resize, flip and convert, on a frame with different channels
+void benchGrayFrame(int _numFrames);
+
+//the frame difference with and without simd, and the vision on a still and a moving scene with the gate on and off
+void benchMotionGate(int _numFrames);
+
+//all of the above, for _numShafts shafts
+void runBenchmarks(int _numShafts);
@@ -0,0 +1,125 @@
+/*
+ * SPARSE WORLD OF CELLS WITHOUT EDGES
+ */
+
+#include "ChunkWorld.h"
+
+ChunkWorld::ChunkWorld()
+{
+  clear();
+}
+
+void ChunkWorld::clear() {
+  chunks.clear();
+  for (int i = 0; i < cacheSize; i++) {
+    cacheKeys[i] = 0;
+    cacheChunks[i] = nullptr;
+  }
+  lookups = 0;
+  misses = 0;
+}
+
+//the chunk with this key or null, the cache is checked first and the hit moved to the front
+ChunkWorld::Chunk* ChunkWorld::find(uint64_t _key) const {
+  lookups++;
+  if (cacheChunks[0] && cacheKeys[0] == _key) {
+    return cacheChunks[0];
+  }
+
+  Chunk* c = nullptr;
+  int slot = cacheSize - 1; //the least recently used is dropped on a miss
+  for (int i = 1; i < cacheSize; i++) {
+    if (cacheChunks[i] && cacheKeys[i] == _key) {
+      c = cacheChunks[i];
+      slot = i;
+      break;
+    }
+  }
+  if (!c) {
+    misses++;
+    auto it = chunks.find(_key);
+    if (it == chunks.end()) {
+      return nullptr;
+    }
+    c = it->second.get();
+  }
+
+  remember(_key, c, slot);
+  return c;
+}
+
+//puts a chunk at the front of the cache, the ones before _slot move back one
+void ChunkWorld::remember(uint64_t _key, Chunk* _chunk, int _slot) const {
+  for (int i = _slot; i > 0; i--) {
+    cacheKeys[i] = cacheKeys[i - 1];
+    cacheChunks[i] = cacheChunks[i - 1];
+  }
+  cacheKeys[0] = _key;
+  cacheChunks[0] = _chunk;
+}
+
+//--------------------------------------------------------------
+bool ChunkWorld::get(int _col, int _row) const {
+  Chunk* c = find(keyOf(_col, _row));
+  if (!c) {
+    return false;
+  }
+  return (c->rows[_row & 63] >> (_col & 63)) & 1;
+}
+
+//the word of the row the cell is in, bit col & 63 is the cell. makes the chunk if needed
+uint64_t& ChunkWorld::word(int _col, int _row) {
+  uint64_t key = keyOf(_col, _row);
+  Chunk* c = find(key);
+  if (!c) {
+    unique_ptr<Chunk> fresh(new Chunk());
+    memset(fresh->rows, 0, sizeof(fresh->rows));
+    c = fresh.get();
+    chunks[key] = move(fresh);
+    remember(key, c, cacheSize - 1);
+  }
+  return c->rows[_row & 63];
+}
+
+void ChunkWorld::flip(int _col, int _row) {
+  word(_col, _row) ^= 1ULL << (_col & 63);
+}
+
+void ChunkWorld::set(int _col, int _row, bool _state) {
+  if (get(_col, _row) == _state) {
+    return;
+  }
+  flip(_col, _row);
+}
+
+//every cell the same, a chunk that is not there is all off
+bool ChunkWorld::same(const ChunkWorld& _other) const {
+  static const Chunk empty = {};
+  for (int pass = 0; pass < 2; pass++) {
+    const ChunkWorld& a = pass == 0 ? *this : _other;
+    const ChunkWorld& b = pass == 0 ? _other : *this;
+    for (const auto& it : a.chunks) {
+      Chunk* other = b.find(it.first);
+      if (memcmp(it.second->rows, other ? other->rows : empty.rows, sizeof(empty.rows)) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//--------------------------------------------------------------
+size_t ChunkWorld::numChunks() const {
+  return chunks.size();
+}
+
+size_t ChunkWorld::getBytes() const {
+  return chunks.size() * sizeof(Chunk);
+}
+
+string ChunkWorld::getStats() const {
+  stringstream ss;
+  ss << "world: " << numChunks() << " chunks, " << getBytes() / 1024 << " kB, "
+     << misses << " of " << lookups << " lookups missed the cache";
+  return ss.str();
+}
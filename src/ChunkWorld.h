@@ -0,0 +1,55 @@
+/*
+ * SPARSE WORLD OF CELLS WITHOUT EDGES
+ *
+ * one bit per cell like the grid of the EntSystem, kept in chunks of 64 x 64
+ * cells (64 words, 512 bytes). a chunk is made the first time a cell in it is
+ * written and found again by its position in a hash map, cells never written
+ * read as off. memory grows with the area the ents have visited, not with the
+ * size of the world.
+ *
+ * ents work on a few chunks at a time, the last ones used are kept in a small
+ * cache in front of the map and most lookups never hash.
+ *
+ * not thread safe, a read can reorder the cache.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class ChunkWorld {
+
+public:
+    static const int chunkSize = 64; //cells per side, one word per row
+    static const int cacheSize = 8;
+
+    struct Chunk {
+      uint64_t rows[chunkSize];
+    };
+
+    ChunkWorld();
+
+    void clear();
+    bool get(int _col, int _row) const;
+    void flip(int _col, int _row);
+    void set(int _col, int _row, bool _state);
+    uint64_t& word(int _col, int _row);
+    bool same(const ChunkWorld& _other) const;
+    size_t numChunks() const;
+    size_t getBytes() const;
+    string getStats() const;
+
+private:
+    //chunk position, (col >> 6, row >> 6) packed into one key
+    static uint64_t keyOf(int _col, int _row) {
+      return (uint64_t)(uint32_t)(_col >> 6) << 32 | (uint32_t)(_row >> 6);
+    }
+    Chunk* find(uint64_t _key) const;
+    void remember(uint64_t _key, Chunk* _chunk, int _slot) const;
+
+    unordered_map<uint64_t, unique_ptr<Chunk>> chunks;
+    //most recently used first, chunk is null in unused slots
+    mutable uint64_t cacheKeys[cacheSize];
+    mutable Chunk* cacheChunks[cacheSize];
+    mutable uint64_t lookups, misses; //chunk lookups and those that went to the map
+};
@@ -20,7 +20,7 @@
 
 Draft::Draft()
 {
-
+  useGL = true;
 }
 
 void Draft::setup(int _numShafts, int _numWarps, float _orgX,
@@ -88,11 +88,21 @@ void Draft::setup(int _numShafts, int _numWarps, float _orgX,
   threadingSimple.resize(numWarps); //used to draw waveforms
   shed.resize(numWarps);
 
+  treadlingPushes = 0;
+  drawDownPushes = 0;
+
   setupThreading();
   setupTieUp();
   setupTreadling();
   //setupDrawDown();
 
+  if (!useGL) {
+    return;
+  }
+
+  //grid and cell meshes, built once
+  renderer.setup(*this);
+
 
   //set up fbo used to send image to thermal printer
   currentRowFbo.allocate(printWidth, printSize, GL_RGBA);
@@ -129,37 +139,11 @@ void Draft::update(){
 //--------------------------------------------------------------
 
 void Draft::draw(){
-
-  //draw background fields
+  //only the cells that changed are sent, the grid is drawn as it was built
+  renderer.update(*this);
   ofFill();
-  ofSetColor(110,20,110);
-  ofDrawRectangle(threadingX, threadingY, wWidth, tHeight);
-
-  ofSetColor(10,20,110);
-  ofDrawRectangle(tieUpX, tieUpY, tWidth, tHeight);
-
-  ofSetColor(10,110,110);
-  ofDrawRectangle(drawDownX, drawDownY,  wWidth, wHeight);
-
-  ofSetColor(75,90,50);
-  ofDrawRectangle(treadlingX, treadlingY,  tWidth, wHeight);
-
-  //draw all the parts
-  drawThreadingSimple();
-  drawTieUp();
-  drawTreadling();
-  drawDrawDown();
-
-  //DRAWING TO FBO FOR PRINTER IMAGE
-  currentRowFbo.begin();
-  ofClear(bg);
-  drawCurrentRow();
-  //  ofDrawLine(0,0,380,0);
-  //  ofDrawLine(380, 0, 370,10);
-  currentRowFbo.end();
-
-  //  ofColor(255);
-  //  currentRowFbo.draw(0,0);
+  ofSetColor(255);
+  renderer.draw();
 }
 
 //--------------------------------------------------------------
@@ -367,6 +351,7 @@ void Draft::updateTreadling() {
   //cout << tempTreadle << endl;
   treadling.push_front(tempTreadle);
   treadling.pop_back();
+  treadlingPushes++;
 }
 
 //----------------------
@@ -375,6 +360,7 @@ void Draft::updateTreadling() {
 void Draft::pushTreadling(int _tempTreadle) {
   treadling.push_front(_tempTreadle);
   treadling.pop_back();
+  treadlingPushes++;
 }
 //----------------------------------------
 
@@ -392,6 +378,7 @@ void Draft::updateDrawDown() {
   shed = testShed;
   drawDown.push_front(shed);
   drawDown.pop_back();
+  drawDownPushes++;
 }
 //--------------------------------------------------------------
 void Draft::updateDrawDownSimple() {
@@ -401,6 +388,7 @@ void Draft::updateDrawDownSimple() {
   shed = testShed;
   drawDown.push_front(shed);
   drawDown.pop_back();
+  drawDownPushes++;
 }
 //--------------------------------------------------------------
 
@@ -690,25 +678,13 @@ void Draft::drawCurrentRow() {
 }
 //--------------------------------------------------------------
 void Draft::drawPattern(float _px, float _py, float _pw, float _ph) {
-  ofSetColor(bg);
-
   float psz = _pw/numWarps;
 
-  for(int i = 0; i < drawDown.size(); i++) {
-    for(int j = 0; j < drawDown[0].size(); j++) {
-      float x = _px + (j * psz);
-      float y = _py + (i * psz);
-
-      ofFill();
-      //if check if val at index (ie 0-numShafts-1) is the same as j, ie x index
-      //set colour to fg if so
-      ofColor c = drawDown[i][j] == 1?fg:bg;
-      ofSetColor(c);
-
-      ofDrawRectangle(x, y, psz, psz);
-    }
-  }
-
+  //same cells as the drawdown, scaled up
+  renderer.update(*this);
+  ofFill();
+  ofSetColor(255);
+  renderer.drawDrawDown(_px, _py, psz/cellSize);
 }
 
 //--------------------------------------------------------------
@@ -744,8 +720,15 @@ string Draft::getCurrentString() {
 }
 
 //--------------------------------------------------------------
-//RETURNS OFIMAGE OF CURRENT PATTERN ROW FOR PRINTING
+//RETURNS OFIMAGE OF CURRENT PATTERN ROW
+//rows are printed straight from the shed (see RasterEncoder), this is only for saving/debugging
 ofImage Draft::getCurrentImg() {
+  //DRAWING TO FBO
+  currentRowFbo.begin();
+  ofClear(bg);
+  drawCurrentRow();
+  currentRowFbo.end();
+
   ofPixels pixels;
   pixels.allocate(ofGetWidth(), ofGetHeight(), 4);
 
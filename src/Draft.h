@@ -17,6 +17,7 @@
 #pragma once
 #include "ofMain.h"
 #include "helpers.h"
+#include "DraftRenderer.h"
 
 class Draft {
 
@@ -90,7 +91,12 @@ void pushThreading(int _tempTreadle);
   vector<int> shed;
   deque<int> threadingSimple; // a single deque used to draw waveforms in the threading
 
-  //fbo for thermal printing
+  //rows pushed so far, the renderer scrolls by the difference
+  uint64_t treadlingPushes, drawDownPushes;
+  DraftRenderer renderer;
+  bool useGL; //false when running headless, no fbo or meshes are made
+
+  //fbo for the current row as an image, not used for printing
   ofFbo currentRowFbo;
 
 };
@@ -0,0 +1,147 @@
+/*
+ * CPU COMPOSITOR FOR PRINTING THE FULL DRAFT
+ *
+ * the draft is a grid of cell rows: numShafts rows of threading/tie-up, one row of
+ * padding and numWeft rows of drawdown/treadling. every cell row only has two
+ * different dot lines, the grid line on top and the line through the cells, so
+ * the compositor makes those two once per cell row and repeats them.
+ *
+ */
+
+#include "DraftCompositor.h"
+
+//--------------------------------------------------------------
+void DraftSnapshot::copyFrom(const Draft& _draft) {
+  numShafts = _draft.numShafts;
+  numWarps = _draft.numWarps;
+  numWeft = _draft.numWeft;
+  threading.assign(_draft.threading.begin(), _draft.threading.end());
+  tieUp = _draft.tieUp;
+  treadling.assign(_draft.treadling.begin(), _draft.treadling.end());
+  drawDown.assign(_draft.drawDown.begin(), _draft.drawDown.end());
+}
+
+//--------------------------------------------------------------
+DraftCompositor::DraftCompositor()
+{
+  draft = nullptr;
+  setup(384, 24);
+}
+
+void DraftCompositor::setup(int _printerDots, int _bandHeight) {
+  printerDots = _printerDots;
+  bandHeight = ofClamp(_bandHeight, 1, 255); //one raster command per band
+  totalLines = 0;
+}
+
+//LAYOUT OF THE SNAPSHOT, biggest cells that fit on the print head
+void DraftCompositor::begin(const DraftSnapshot& _draft) {
+  draft = &_draft;
+
+  int cols = draft->numWarps + 1 + draft->numShafts;
+  cellDots = max(2, (printerDots - 1) / max(cols, 1));
+  int w = cols * cellDots + 1;
+  leftPad = max(0, (printerDots - w) / 2);
+  bytesPerLine = min(printerDots / 8, (leftPad + w + 7) / 8);
+
+  leftX = leftPad;
+  rightX = leftPad + (draft->numWarps + 1) * cellDots;
+  numCellRows = draft->numShafts + 1 + draft->numWeft;
+  totalLines = numCellRows * cellDots + 1; //+1 for the closing grid line
+
+  lineRow = -1;
+}
+
+int DraftCompositor::getNumBands() {
+  return (totalLines + bandHeight - 1) / bandHeight;
+}
+
+//--------------------------------------------------------------
+//ONE BAND AS A RASTER COMMAND
+void DraftCompositor::appendBand(vector<unsigned char>& _out, int _band) {
+  int y0 = _band * bandHeight;
+  int y1 = min(y0 + bandHeight, totalLines);
+  if (draft == nullptr || y0 >= y1) {
+    return;
+  }
+
+  _out.push_back(18); //DC2 * r n
+  _out.push_back(42);
+  _out.push_back((unsigned char)(y1 - y0));
+  _out.push_back((unsigned char)bytesPerLine);
+
+  for (int y = y0; y < y1; y++) {
+    int cellRow = y / cellDots;
+    if (cellRow != lineRow) {
+      makeCellRow(cellRow);
+    }
+    const vector<unsigned char>& line = y % cellDots == 0 ? gridLine : cellLine;
+    _out.insert(_out.end(), line.begin(), line.end());
+  }
+}
+
+//--------------------------------------------------------------
+//GRID LINE + CELL LINE OF A CELL ROW
+void DraftCompositor::makeCellRow(int _cellRow) {
+  lineRow = _cellRow;
+  gridLine.assign(bytesPerLine, 0);
+  cellLine.assign(bytesPerLine, 0);
+
+  int numShafts = draft->numShafts;
+  int numWarps = draft->numWarps;
+  int w = _cellRow - numShafts - 1; //row in drawdown/treadling
+
+  if (_cellRow < numShafts) {
+    //THREADING
+    boxRow(leftX, numWarps, draft->threading[_cellRow].data());
+    //TIE-UP, drawn with the first index as x (see Draft::drawTieUp)
+    rowCells.resize(numShafts);
+    for (int i = 0; i < numShafts; i++) {
+      rowCells[i] = draft->tieUp[i][_cellRow];
+    }
+    boxRow(rightX, numShafts, rowCells.data());
+  } else if (w >= 0 && w < draft->numWeft) {
+    //DRAWDOWN
+    boxRow(leftX, numWarps, draft->drawDown[w].data());
+    //TREADLING
+    rowCells.resize(numShafts);
+    for (int i = 0; i < numShafts; i++) {
+      rowCells[i] = draft->treadling[w] == i ? 1 : 0;
+    }
+    boxRow(rightX, numShafts, rowCells.data());
+  } else {
+    //padding row or the closing line, only the bottom edges of the boxes above
+    setSpan(gridLine, leftX, leftX + numWarps * cellDots + 1);
+    setSpan(gridLine, rightX, rightX + numShafts * cellDots + 1);
+  }
+}
+
+//one row of a box: the top grid line, the vertical grid lines and the filled cells
+void DraftCompositor::boxRow(int _x, int _numCells, const int* _cells) {
+  setSpan(gridLine, _x, _x + _numCells * cellDots + 1);
+  for (int k = 0; k <= _numCells; k++) {
+    setSpan(cellLine, _x + k * cellDots, _x + k * cellDots + 1);
+  }
+  for (int k = 0; k < _numCells; k++) {
+    if (_cells[k] > 0) {
+      setSpan(cellLine, _x + k * cellDots + 1, _x + (k + 1) * cellDots);
+    }
+  }
+}
+
+//set dots x0 to x1 (not included), whole bytes at a time where possible
+void DraftCompositor::setSpan(vector<unsigned char>& _line, int _x0, int _x1) {
+  _x1 = min(_x1, (int)_line.size() * 8);
+  while (_x0 < _x1 && (_x0 & 7) != 0) {
+    _line[_x0 >> 3] |= (unsigned char)(0x80 >> (_x0 & 7));
+    _x0++;
+  }
+  while (_x0 + 8 <= _x1) {
+    _line[_x0 >> 3] = 0xff;
+    _x0 += 8;
+  }
+  while (_x0 < _x1) {
+    _line[_x0 >> 3] |= (unsigned char)(0x80 >> (_x0 & 7));
+    _x0++;
+  }
+}
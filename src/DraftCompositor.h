@@ -0,0 +1,59 @@
+/*
+ * CPU COMPOSITOR FOR PRINTING THE FULL DRAFT
+ *
+ * renders threading, tie-up, treadling and drawdown (same layout as Draft::draw)
+ * straight into 1-bit printer bands of a fixed number of dot lines.
+ * the printer thread asks for one band at a time and writes it before the next
+ * one is made, so memory stays at one band no matter how long the draft is.
+ *
+ * the compositor works on a snapshot of the draft, the generation keeps running
+ * while the snapshot is printed.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "Draft.h"
+
+//copy of the parts of the draft needed to print it
+struct DraftSnapshot {
+  void copyFrom(const Draft& _draft);
+
+  int numShafts = 0;
+  int numWarps = 0;
+  int numWeft = 0;
+  vector<vector<int>> threading;
+  vector<vector<int>> tieUp;
+  vector<int> treadling;
+  vector<vector<int>> drawDown;
+};
+
+class DraftCompositor {
+
+public:
+    DraftCompositor();
+
+    void setup(int _printerDots, int _bandHeight);
+    void begin(const DraftSnapshot& _draft);
+    int getNumBands();
+    void appendBand(vector<unsigned char>& _out, int _band);
+
+    int printerDots, bandHeight;
+
+    //layout of the current snapshot in dots
+    int cellDots; //size of a cell, grid line included
+    int leftPad, bytesPerLine, totalLines, numCellRows;
+    int leftX, rightX; //x of threading/drawdown and of tieUp/treadling
+
+private:
+    void makeCellRow(int _cellRow);
+    void boxRow(int _x, int _numCells, const int* _cells);
+    void setSpan(vector<unsigned char>& _line, int _x0, int _x1);
+
+    const DraftSnapshot* draft;
+    vector<int> rowCells; //values of the cells of one box row, reused
+
+    //the two different dot lines of the current cell row
+    int lineRow;
+    vector<unsigned char> gridLine, cellLine;
+};
@@ -0,0 +1,237 @@
+/*
+ * RETAINED RENDERER FOR THE DRAFT
+ *
+ * same layout as the immediate draw functions of Draft (still used for draftToImg).
+ * the coloured background fields of Draft::draw are left out, the cells cover them.
+ *
+ */
+
+#include "DraftRenderer.h"
+#include "Draft.h"
+
+//--------------------------------------------------------------
+void CellLayer::setup(float _x, float _y, int _cols, int _rows, float _cellSize, ofColor _bg) {
+  x = _x;
+  y = _y;
+  cols = max(_cols, 0);
+  rows = max(_rows, 0);
+  cellSize = _cellSize;
+  head = 0;
+  pushes = 0;
+  cellsPatched = 0;
+
+  //two triangles per cell, at the origin of the layer in slot order
+  vector<glm::vec3> verts;
+  verts.reserve(cols * rows * 6);
+  for (int r = 0; r < rows; r++) {
+    for (int c = 0; c < cols; c++) {
+      float x0 = c * cellSize;
+      float y0 = r * cellSize;
+      float x1 = x0 + cellSize;
+      float y1 = y0 + cellSize;
+      verts.push_back(glm::vec3(x0, y0, 0));
+      verts.push_back(glm::vec3(x1, y0, 0));
+      verts.push_back(glm::vec3(x1, y1, 0));
+      verts.push_back(glm::vec3(x0, y0, 0));
+      verts.push_back(glm::vec3(x1, y1, 0));
+      verts.push_back(glm::vec3(x0, y1, 0));
+    }
+  }
+  colors.assign(verts.size(), ofFloatColor(_bg));
+  state.assign(cols * rows, 0);
+  dirtyBegin = cols * rows;
+  dirtyEnd = 0;
+
+  if (!verts.empty()) {
+    vbo.setVertexData(verts.data(), verts.size(), GL_STATIC_DRAW);
+    vbo.setColorData(colors.data(), colors.size(), GL_DYNAMIC_DRAW);
+  }
+}
+
+//SETS THE CELL AT A ROW OF THE DRAFT, only touches the colours if it flipped
+void CellLayer::set(int _row, int _col, bool _on, const ofFloatColor& _fg, const ofFloatColor& _bg) {
+  int slot = (head + _row) % rows;
+  int idx = slot * cols + _col;
+  if (state[idx] == _on) {
+    return;
+  }
+  state[idx] = _on;
+  const ofFloatColor& c = _on ? _fg : _bg;
+  for (int v = 0; v < 6; v++) {
+    colors[idx * 6 + v] = c;
+  }
+  dirtyBegin = min(dirtyBegin, idx);
+  dirtyEnd = max(dirtyEnd, idx + 1);
+  cellsPatched++;
+}
+
+//moves the top of the ring up by the number of rows pushed since last time
+void CellLayer::scroll(uint64_t _pushes) {
+  if (rows == 0) {
+    return;
+  }
+  int steps = (int)((_pushes - pushes) % rows);
+  head = (head - steps + rows) % rows;
+  pushes = _pushes;
+}
+
+//sends the colours of the flipped cells, one range per layer
+void CellLayer::upload() {
+  if (dirtyEnd <= dirtyBegin) {
+    return;
+  }
+  size_t first = dirtyBegin * 6;
+  size_t count = (dirtyEnd - dirtyBegin) * 6;
+  vbo.getColorBuffer().updateData(first * sizeof(ofFloatColor), count * sizeof(ofFloatColor), &colors[first]);
+  dirtyBegin = cols * rows;
+  dirtyEnd = 0;
+}
+
+//the ring from head to the end on top, from 0 to head below it
+int CellLayer::draw() {
+  if (rows == 0 || cols == 0) {
+    return 0;
+  }
+  int perRow = cols * 6;
+  ofPushMatrix();
+  ofTranslate(x, y - head * cellSize);
+  vbo.draw(GL_TRIANGLES, head * perRow, (rows - head) * perRow);
+  if (head == 0) {
+    ofPopMatrix();
+    return 1;
+  }
+  ofTranslate(0, rows * cellSize);
+  vbo.draw(GL_TRIANGLES, 0, head * perRow);
+  ofPopMatrix();
+  return 2;
+}
+
+//--------------------------------------------------------------
+DraftRenderer::DraftRenderer()
+{
+  drawCalls = 0;
+  lastFrame = UINT64_MAX;
+}
+
+void DraftRenderer::setup(const Draft& _draft) {
+  fg = ofFloatColor(_draft.fg);
+  bg = ofFloatColor(_draft.bg);
+  float cs = _draft.cellSize;
+
+  threading.setup(_draft.threadingX, _draft.threadingY, _draft.numWarps, _draft.numShafts, cs, _draft.bg);
+  tieUp.setup(_draft.tieUpX, _draft.tieUpY, _draft.numShafts, _draft.numShafts, cs, _draft.bg);
+  treadling.setup(_draft.treadlingX, _draft.treadlingY, _draft.numShafts, _draft.numWeft, cs, _draft.bg);
+  drawDown.setup(_draft.drawDownX, _draft.drawDownY, _draft.numWarps, _draft.numWeft, cs, _draft.bg);
+  treadling.pushes = _draft.treadlingPushes;
+  drawDown.pushes = _draft.drawDownPushes;
+
+  //BOXES, the padding around every part
+  boxes.clear();
+  boxes.setMode(OF_PRIMITIVE_TRIANGLES);
+  grid.clear();
+  grid.setMode(OF_PRIMITIVE_LINES);
+  for (CellLayer* l : {&threading, &tieUp, &treadling, &drawDown}) {
+    float w = l->cols * cs;
+    float h = l->rows * cs;
+    float x0 = l->x - 2;
+    float y0 = l->y - 2;
+    float x1 = l->x + w + 2;
+    float y1 = l->y + h + 2;
+    glm::vec3 corners[6] = {{x0, y0, 0}, {x1, y0, 0}, {x1, y1, 0}, {x0, y0, 0}, {x1, y1, 0}, {x0, y1, 0}};
+    for (auto& p : corners) {
+      boxes.addVertex(p);
+      boxes.addColor(bg);
+    }
+
+    //GRID, one line per row and column plus the far edges
+    for (int c = 0; c <= l->cols; c++) {
+      grid.addVertex(glm::vec3(l->x + c * cs, l->y, 0));
+      grid.addVertex(glm::vec3(l->x + c * cs, l->y + h, 0));
+      grid.addColor(fg);
+      grid.addColor(fg);
+    }
+    for (int r = 0; r <= l->rows; r++) {
+      grid.addVertex(glm::vec3(l->x, l->y + r * cs, 0));
+      grid.addVertex(glm::vec3(l->x + w, l->y + r * cs, 0));
+      grid.addColor(fg);
+      grid.addColor(fg);
+    }
+  }
+
+  //cells are patched on the first draw
+  lastFrame = UINT64_MAX;
+}
+
+//--------------------------------------------------------------
+//compares the draft with the cells on the gpu and patches what flipped, once a frame
+void DraftRenderer::update(const Draft& _draft) {
+  uint64_t frame = ofGetFrameNum();
+  if (frame == lastFrame) {
+    return;
+  }
+  lastFrame = frame;
+  drawCalls = 0;
+
+  for (int i = 0; i < threading.rows; i++) {
+    for (int j = 0; j < threading.cols; j++) {
+      threading.set(i, j, _draft.threadingSimple[j] == i, fg, bg);
+    }
+  }
+  for (int i = 0; i < tieUp.rows; i++) {
+    for (int j = 0; j < tieUp.cols; j++) {
+      tieUp.set(i, j, _draft.tieUp[j][i] > 0, fg, bg);
+    }
+  }
+
+  //the rows already on the gpu move down with the ring, only new rows differ
+  treadling.scroll(_draft.treadlingPushes);
+  for (int i = 0; i < treadling.rows; i++) {
+    for (int j = 0; j < treadling.cols; j++) {
+      treadling.set(i, j, _draft.treadling[i] == j, fg, bg);
+    }
+  }
+  drawDown.scroll(_draft.drawDownPushes);
+  for (int i = 0; i < drawDown.rows; i++) {
+    const vector<int>& row = _draft.drawDown[i];
+    for (int j = 0; j < drawDown.cols; j++) {
+      drawDown.set(i, j, row[j] == 1, fg, bg);
+    }
+  }
+
+  threading.upload();
+  tieUp.upload();
+  treadling.upload();
+  drawDown.upload();
+}
+
+//--------------------------------------------------------------
+void DraftRenderer::draw() {
+  boxes.draw();
+  drawCalls++;
+
+  drawCalls += threading.draw();
+  drawCalls += tieUp.draw();
+  drawCalls += treadling.draw();
+  drawCalls += drawDown.draw();
+
+  ofSetLineWidth(2);
+  grid.draw();
+  drawCalls++;
+}
+
+//DRAWDOWN ONLY, scaled, used for the full screen pattern
+void DraftRenderer::drawDrawDown(float _x, float _y, float _scale) {
+  ofPushMatrix();
+  ofTranslate(_x, _y);
+  ofScale(_scale, _scale);
+  ofTranslate(-drawDown.x, -drawDown.y);
+  drawCalls += drawDown.draw();
+  ofPopMatrix();
+}
+
+string DraftRenderer::getStats() {
+  uint64_t patched = threading.cellsPatched + tieUp.cellsPatched + treadling.cellsPatched + drawDown.cellsPatched;
+  stringstream ss;
+  ss << "draft: " << drawCalls << " draws/frame, " << patched << " cells patched";
+  return ss.str();
+}
@@ -0,0 +1,56 @@
+/*
+ * RETAINED RENDERER FOR THE DRAFT
+ *
+ * draws the draft with a handful of vbo draws instead of a rectangle per cell.
+ * the grid, the box edges and the padding around the boxes never change, they
+ * are one mesh built at setup. every part of the draft is a vertex coloured mesh
+ * of cells, and only the colours of cells that flipped since the last frame are
+ * sent to the gpu.
+ *
+ * treadling and drawdown scroll down one row per push. they are rings: the new
+ * row is written over the oldest one and the ring is drawn in two pieces with an
+ * offset, so scrolling moves a start index instead of every cell.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class Draft;
+
+//one part of the draft, cols x rows cells, 6 vertices per cell
+struct CellLayer {
+  void setup(float _x, float _y, int _cols, int _rows, float _cellSize, ofColor _bg);
+  void set(int _row, int _col, bool _on, const ofFloatColor& _fg, const ofFloatColor& _bg);
+  void scroll(uint64_t _pushes);
+  void upload();
+  int draw();
+
+  float x, y, cellSize;
+  int cols, rows;
+  int head; //slot of the top row, the newest row in a ring
+  uint64_t pushes; //pushes of the draft already scrolled in
+  ofVbo vbo;
+  vector<ofFloatColor> colors;
+  vector<unsigned char> state;
+  int dirtyBegin, dirtyEnd; //range of cells to send, in slot order
+  uint64_t cellsPatched;
+};
+
+class DraftRenderer {
+
+public:
+    DraftRenderer();
+
+    void setup(const Draft& _draft);
+    void update(const Draft& _draft);
+    void draw();
+    void drawDrawDown(float _x, float _y, float _scale);
+    string getStats();
+
+    CellLayer threading, tieUp, treadling, drawDown;
+    ofVboMesh boxes, grid; //static, built once
+    ofFloatColor fg, bg;
+    int drawCalls; //draws of the current frame
+    uint64_t lastFrame; //frame of the last update
+};
@@ -4,6 +4,7 @@
  * similar to langtons ant / turmites
  *
  * walk a step, turn towards direction
+ * what an ent does on a cell is looked up in the TurmiteRules of the EntSystem
  *
  * REFERENCE:
  * https://mathworld.wolfram.com/LangtonsAnt.html
@@ -21,15 +22,20 @@ Ent::Ent()
 
 }
 
-void Ent::setup(float _posX, float _posY, float _sz, float _minX, float _minY, float _maxX, float _maxY) {
+void Ent::setup(int _col, int _row, float _sz, float _minX, float _minY, float _maxX, float _maxY) {
   //VARS
-  posX = _posX;
-  posY = _posY;
+  col = _col;
+  row = _row;
+  midCol = col;
+  midRow = row;
   sz = _sz;
   minX = _minX;
   minY = _minY;
   maxX = _maxX;
   maxY = _maxY;
+  numCols = round((maxX - minX) / sz);
+  numRows = round((maxY - minY) / sz);
+  wrap = true;
   //random inversion rule
   inv = ofRandom(1)>0.5?true:false;
   dir = 0; //0 = north, 1 = east, 2 = south = 3 = west;
@@ -40,9 +46,11 @@ void Ent::setup(float _posX, float _posY, float _sz, float _minX, float _minY, f
 }
 
 void Ent::update() {
-  midX = posX + sz/2;
-  midY = posY + sz/2;
-  checkEdges();
+  midCol = col;
+  midRow = row;
+  if (wrap) {
+    checkEdges();
+  }
 }
 
 void Ent::display() {
@@ -53,134 +61,21 @@ void Ent::display() {
     ofSetColor(224, 99, 139);
   }
 
-  ofDrawRectangle(posX, posY, sz, sz);
+  ofDrawRectangle(minX + col * sz, minY + row * sz, sz, sz);
 }
 
 
 
-//ADVANCE if direction =North East South West go there
-void Ent::adv() {
-
-  switch (dir) {
-  case 0:
-    posY-=sz;
-    break;
-  case 1:
-    posX+=sz;
-    break;
-  case 2:
-    posY+=sz;
-    break;
-  case 3:
-    posX-=sz;
-    break;
-  default:
-    break;
-  }
-
-}
-
+//one axis per update, off the grid the ent skips a step like it always has
 void Ent::checkEdges() {
-  if (posX > maxX - sz) {
-    posX = minX;
-  } else if (posX < minX) {
-    posX = maxX - sz;
-  } else if (posY > maxY - sz) {
-    posY = minY;
-  } else if (posY < minY) {
-    posY = maxY - sz;
+  if (col > numCols - 1) {
+    col = 0;
+  } else if (col < 0) {
+    col = numCols - 1;
+  } else if (row > numRows - 1) {
+    row = 0;
+  } else if (row < 0) {
+    row = numRows - 1;
   }
 }
 
-
-//THE DIFFERENT RULES OF NAVIGATION
-//MOVE "RIGHT"
-void Ent::right() {
-
-  switch (state) {
-  case 0:
-    if(inv) {
-      dir = (dir+1) % 4;
-    } else {
-      dir = ((dir-1)+4) % 4;
-    }
-    adv();
-    break;
-  case 1:
-    if(inv) {
-      dir = (dir+1) % 4;
-    } else {
-      dir = ((dir-1)+4) % 4;
-    }
-    adv();
-    if(inv) {
-      dir = ((dir-1)+4) % 4;
-    } else {
-      dir = (dir+1) % 4;
-    }
-    adv();
-    break;
-  case 2:
-    if(inv) {
-      dir = (dir+1) % 4;
-    } else {
-      dir = ((dir-1)+4) % 4;
-    }
-    adv();
-    break;
-  case 3:
-    adv();
-    break;
-  default:
-    if(inv) {
-      dir = (dir+1) % 4;
-    } else {
-      dir = ((dir-1)+4) % 4;
-    }
-    adv();
-    break;
-  }
-}
-
-//MOVE "LEFT"
-void Ent::left() {
-  switch (state) {
-  case 0:
-    if(inv) {
-      dir = ((dir-1)+4) % 4;
-    } else {
-      dir = (dir+1) % 4;
-    }
-    adv();
-    break;
-  case 1:
-    if(inv) {
-      dir = ((dir-1)+4) % 4;
-    } else {
-      dir = (dir+1) % 4;
-    }
-    adv();
-    if(inv) {
-      dir = ((dir-1)+4) % 2;
-    } else {
-      dir = (dir+1) % 2;
-    }
-    adv();
-    break;
-  case 2:
-    adv();
-    adv();
-    break;
-  case 3:
-    adv();
-    break;
-  default:
-    if(inv) {
-      dir = ((dir-1)+4) % 4;
-    } else {
-      dir = (dir+1) % 4;
-    }
-    adv();
-    break;
-  }
-}
@@ -7,18 +7,20 @@ class Ent
 {
 public:
     Ent();
-    void setup(float _posX, float _posY, float _sz, float _minX, float _minY, float _maxX, float _maxY);
+    void setup(int _col, int _row, float _sz, float _minX, float _minY, float _maxX, float _maxY);
     void update();
     void display();
 
-    void left();
-    void right();
-    void adv();
     void checkEdges();
 
-    float posX, posY, sz, minX, minY, maxX, maxY, midX, midY;
+    float sz, minX, minY, maxX, maxY;
+    int col, row; //position in cells
+    int midCol, midRow; //cell under the ent at the last update, the one it acts on
+    int numCols, numRows; //cells within min/max
     bool inv;
-    int dir, state;
+    bool wrap; //false in an unbounded world
+    int dir; //0 = north, 1 = east, 2 = south, 3 = west
+    int state; //row of the rules table
 
 
 
@@ -8,10 +8,37 @@
 
 
 #include "EntSystem.h"
+#include <climits>
+
+//splitmix64, spreads a counter over all 64 bits
+static uint64_t mix64(uint64_t _x) {
+  _x += 0x9E3779B97F4A7C15ULL;
+  _x = (_x ^ (_x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  _x = (_x ^ (_x >> 27)) * 0x94D049BB133111EBULL;
+  return _x ^ (_x >> 31);
+}
+
+//_a is _b moved by _col, _row
+static bool sameEnt(const Ent& _a, const Ent& _b, int _col, int _row) {
+  return _a.col == _b.col + _col && _a.row == _b.row + _row && _a.midCol == _b.midCol + _col &&
+         _a.midRow == _b.midRow + _row && _a.dir == _b.dir && _a.state == _b.state && _a.inv == _b.inv;
+}
 
 EntSystem::EntSystem()
 {
-
+  cellOn = ofColor(0);
+  cellOff = ofColor(255);
+  useGL = true;
+  numThreads = 1;
+  unbounded = false;
+  setRules(entRules());
+  texFull = false;
+  texelsPatched = 0;
+  detectCycles = false;
+  tick = 0;
+  cellEdits = 0;
+  ticksSkipped = 0;
+  resetCycles();
 }
 
 void EntSystem::setup(int _numCols, float _sz, int _numEnts, float _minX, float _minY, float _maxX, float _maxY) {
@@ -24,8 +51,14 @@ void EntSystem::setup(int _numCols, float _sz, int _numEnts, float _minX, float
   numCols = _numCols; //number of columns
   numRows = round(height/sz); //number of rows
 
-  //CELL GRID
-  cellGrid.resize(numCols, vector<Cell>(numRows));
+  //CELL GRID, all off
+  wordsPerRow = (numCols + 63) / 64;
+  lastWordMask = numCols % 64 == 0 ? ~0ULL : (1ULL << (numCols % 64)) - 1;
+  cells.assign(numRows * wordsPerRow, 0);
+  world.clear();
+  cellEdits++;
+  tick = 0;
+  resetCycles();
 
   //flowstates that is how much influence the entities are getting from camera interaction
   flowStates.resize(numEnts);
@@ -33,28 +66,21 @@ void EntSystem::setup(int _numCols, float _sz, int _numEnts, float _minX, float
     flowStates[i] = i;
   }
 
-  //setting up grid of cells
-  for (int i = 0; i < numCols; i++) {
-    for (int j = 0; j < numRows; j++) {
-      float x = sz * i;
-      float y = sz * j;
-
-      Cell tempCell;
-      bool rState = ofRandom(1) > 0.5?true:false;
-      tempCell.setup(x,y,sz,false);
-      cellGrid[i][j] = tempCell;
-    }
+  //GRID TEXTURE, all cells are sent on the first display
+  rowCol0.assign(numRows, numCols);
+  rowCol1.assign(numRows, -1);
+  markAll();
+  if (useGL) {
+    cellTex.allocate(numCols, numRows, GL_RGBA);
+    cellTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
   }
 
-
   //SETUP ENTS
   for (int i = 0; i < numEnts; i++) {
-    int rx =  (int)ofRandom(cellGrid.size());
-    int ry =  (int)ofRandom(cellGrid[0].size());
-    float x = cellGrid[rx][ry].posX;
-    float y = cellGrid[rx][ry].posY;
+    int rx =  (int)ofRandom(numCols);
+    int ry =  (int)ofRandom(numRows);
     Ent tempEnt;
-    tempEnt.setup(x, y, sz, _minX, _minY, _maxX, _maxY);
+    tempEnt.setup(rx, ry, sz, _minX, _minY, _maxX, _maxY);
     states.resize(numEnts);
 
     entArr.push_back(tempEnt);
@@ -62,57 +88,180 @@ void EntSystem::setup(int _numCols, float _sz, int _numEnts, float _minX, float
 
   //clear entArray
   entArr.resize(numEnts);
+  for (Ent& e : entArr) {
+    e.wrap = !unbounded;
+  }
+  stepStates.assign(numEnts, 0);
 }
 
 void EntSystem::update(int _flow) {
   //calculate flow array
   calcFlowArr(_flow);
+  stepN(1);
+}
 
+//ONE TICK, every ent acts on its cell and moves
+void EntSystem::step() {
   //update and change the ents directions
-  for(int i = 0; i < entArr.size(); i++) {
-    doChange(entArr[i], i);
-    entArr[i].update();
+  //the world makes chunks as ents walk, only one thread may touch it
+  if (numThreads > 1 && !unbounded) {
+    updateParallel();
+  } else {
+    for(int i = 0; i < entArr.size(); i++) {
+      doChange(entArr[i], i);
+      entArr[i].update();
+    }
   }
 
   if (morph == true) {
     totalSideWipe();
   }
+
+  tick++;
+  if (detectCycles) {
+    checkCycle();
+  }
+}
+
+//MANY TICKS IN A ROW, for evolving ahead at startup or while nobody is around
+//per ent the state most of the ticks wrote, the same as the last state for 1 tick.
+//with detectCycles on, whole periods of a repeat are skipped and counted at once
+const vector<int>& EntSystem::stepN(int _n) {
+  onCounts.assign(entArr.size(), 0);
+  uint64_t end = tick + max(_n, 0);
+  uint64_t periodTick = UINT64_MAX; //an aligned tick already passed in this call
+  while (tick < end) {
+    if (detectCycles && cyclePeriod > 0 && (tick - checkTick) % cyclePeriod == 0) {
+      if (getStateHash() != check.hash || cellEdits != check.edits) {
+        resetCycles();
+        periodTick = UINT64_MAX;
+      } else if (periodTick != UINT64_MAX) {
+        //one whole period was stepped since, every further period counts the same
+        uint64_t periods = skipPeriods((end - tick) / cyclePeriod);
+        for (int i = 0; i < onCounts.size(); i++) {
+          onCounts[i] += periods * (onCounts[i] - periodCounts[i]);
+        }
+        periodTick = UINT64_MAX;
+        if (tick == end) {
+          break;
+        }
+      } else {
+        periodTick = tick;
+        periodCounts = onCounts;
+      }
+    }
+    step();
+    for (int i = 0; i < onCounts.size(); i++) {
+      onCounts[i] += states[i];
+    }
+  }
+
+  stepStates.resize(entArr.size());
+  for (int i = 0; i < stepStates.size(); i++) {
+    stepStates[i] = 2 * onCounts[i] > (uint64_t)_n ? 1 : 0;
+  }
+  return stepStates;
 }
 
 //THE CHANGING ALGORITHM/RULE APPLICATION
+//the cell under the ent is looked up directly, an ent off the grid does nothing
 void EntSystem::doChange(Ent& tempEnt, int idx) {
-  float x = tempEnt.midX;
-  float y = tempEnt.midY;
-
-  for(int i = 0; i < cellGrid.size(); i++) {
-    for(int j = 0; j < cellGrid[i].size(); j++) {
-
-      //if within bounds
-      if (cellGrid[i][j].withinBounds(x, y)) {
-        if (cellGrid[i][j].state == true) {
-          tempEnt.right();
-          cellGrid[i][j].stateFlip();
-          states[idx] = cellGrid[i][j].state==true?1:0;
-        } else {
-          tempEnt.left();
-          cellGrid[i][j].stateFlip();
-          states[idx] = cellGrid[i][j].state==true?1:0;
-        }
+  if (turnEnt(tempEnt, idx)) {
+    markCell(tempEnt.midCol, tempEnt.midRow);
+  }
+}
+
+//turns and moves the ent and writes its cell, one lookup in the rules.
+//true if the cell flipped, an ent off the grid does nothing. in an unbounded
+//world there is no off the grid
+//touches nothing but the ent, its state and the bit under it
+bool EntSystem::turnEnt(Ent& tempEnt, int idx) {
+  int i = tempEnt.midCol;
+  int j = tempEnt.midRow;
+  uint64_t* cell;
+  if (unbounded) {
+    cell = &world.word(i, j);
+  } else if (i < 0 || i >= numCols || j < 0 || j >= numRows) {
+    return false;
+  } else {
+    cell = &cells[j * wordsPerRow + (i >> 6)];
+  }
+
+  uint64_t& word = *cell;
+  int colour = (word >> (i & 63)) & 1;
+  const TurmiteRules<2>::Step& step = (tempEnt.inv ? rulesInv : rules).get(tempEnt.state, colour, tempEnt.dir);
+  tempEnt.col += step.dCol;
+  tempEnt.row += step.dRow;
+  tempEnt.dir = step.dir;
+  tempEnt.state = step.next;
+  word ^= (uint64_t)(colour ^ step.write) << (i & 63);
+  states[idx] = step.write;
+  return colour != step.write;
+}
+
+//--------------------------------------------------------------
+//SAME RESULT AS THE SERIAL LOOP
+//an ent only changes the cell it stands on at the start of the tick. ents on
+//different cells are independent, ents on the same cell are in the same band
+//and are stepped in index order, like the serial loop does. bands are whole rows
+//so no two threads write the same word.
+void EntSystem::updateParallel() {
+  int numBands = min(numRows, pool.size() * 4);
+  if (numBands < 1) {
+    return;
+  }
+  bandEnts.resize(numBands);
+  bandFlipped.resize(numBands);
+  for (auto& b : bandEnts) {
+    b.clear();
+  }
+  for (int i = 0; i < entArr.size(); i++) {
+    int row = ofClamp(entArr[i].midRow, 0, numRows - 1);
+    bandEnts[row * numBands / numRows].push_back(i);
+  }
+
+  pool.run(numBands, [this](int b) {
+    bandFlipped[b].clear();
+    for (int i : bandEnts[b]) {
+      Ent& e = entArr[i];
+      if (turnEnt(e, i)) {
+        bandFlipped[b].push_back(e.midCol + e.midRow * numCols);
       }
+      e.update();
+    }
+  });
+
+  //the texture list is not thread safe, cells are queued after
+  for (auto& b : bandFlipped) {
+    for (int idx : b) {
+      markCell(idx % numCols, idx / numCols);
     }
   }
 }
 
+//1 steps on the calling thread only
+void EntSystem::setThreads(int _numThreads) {
+  numThreads = max(_numThreads, 1);
+  pool.setup(numThreads);
+}
+
 //RULE CHANGING FUNCTIONS
+//a new table for all ents, inverted ents get it with the turns the other way
+void EntSystem::setRules(const TurmiteRules<2>& _rules) {
+  rules = _rules;
+  rulesInv = _rules.mirrored();
+}
+
+//the state of an ent picks its row in the table
 //random rule for single entity
 void EntSystem::randomIndividRule(int idx) {
-  int dirState = (int)ofRandom(4);
+  int dirState = (int)ofRandom(rules.numStates);
   entArr[idx].state = dirState;
 }
 
 //single random rule applied for all ents/objects
 void EntSystem::massRandomRules() {
-  int dirState = (int)ofRandom(4);
+  int dirState = (int)ofRandom(rules.numStates);
   for(int i = 0; i < entArr.size(); i++) {
     entArr[i].state = dirState;
   }
@@ -120,9 +269,9 @@ void EntSystem::massRandomRules() {
 
 //random rules for all ents
 void EntSystem::randomRules() {
-  int dirState = (int)ofRandom(4);
+  int dirState = (int)ofRandom(rules.numStates);
   for(int i = 0; i < entArr.size(); i++) {
-    int dirState = (int)ofRandom(4);
+    int dirState = (int)ofRandom(rules.numStates);
     entArr[i].state = dirState;
   }
 }
@@ -136,17 +285,19 @@ void EntSystem::idxRules() {
 }
 
 //flowstates
-vector<int> EntSystem::calcFlowArr(int _flow) {
+const vector<int>& EntSystem::calcFlowArr(int _flow) {
   return flowStates;
 }
 
 //DRAW/DISPLAY
+//the grid is one texture stretched over the cells, patched where cells flipped
 void EntSystem::display() {
-  for(int i = 0; i < cellGrid.size(); i++) {
-    for(int j = 0; j < cellGrid[i].size(); j++) {
-      cellGrid[i][j].display();
-    }
+  if (!useGL) {
+    return;
   }
+  uploadCells();
+  ofSetColor(255);
+  cellTex.draw(0, 0, numCols * sz, numRows * sz);
 
   for(int k = 0; k < entArr.size(); k++) {
     entArr[k].display();
@@ -154,9 +305,10 @@ void EntSystem::display() {
 }
 
 //GET THE TOTAL STATES ADDED TOGETHER INTO ONE INT
+//states of the last update or stepN
 int EntSystem::getStateTotal() {
   int totStates = 0;
-  for(auto a : states) {
+  for(auto a : stepStates) {
     totStates+=a;
   }
   totStates = ofClamp(totStates, 0, 4);
@@ -164,23 +316,54 @@ int EntSystem::getStateTotal() {
 }
 
 //GET THE STATE ARRAY
-vector<int> EntSystem::getStateArr() {
-  return states;
+const vector<int>& EntSystem::getStateArr() {
+  return stepStates;
 }
 
 //MORPH FUNCTIONS - CHANNGES TO ENVIRONMENT
+//whole grid changes work on 64 cells at a time, the texture is sent in full after
 //--------------------------------------------------------------
 void EntSystem::totalCellFlip() {
-  for(int i = 0; i < cellGrid.size(); i++){
-    for(int j = 0; j < cellGrid[0].size(); j++){
-      cellGrid[i][j].stateFlip();
-    }
+  if (unbounded) {
+    forWindow([this](int i, int j) { flipCell(i, j); });
+    return;
   }
+  for (size_t w = 0; w < cells.size(); w++) {
+    cells[w] = ~cells[w];
+  }
+  //columns past numCols stay off
+  for (int j = 0; j < numRows; j++) {
+    cells[j * wordsPerRow + wordsPerRow - 1] &= lastWordMask;
+  }
+  cellEdits++;
+  markAll();
 }
+void EntSystem::totalCellOff() {
+  if (unbounded) {
+    forWindow([this](int i, int j) { setCell(i, j, false); });
+    return;
+  }
+  fill(cells.begin(), cells.end(), 0);
+  cellEdits++;
+  markAll();
+}
+void EntSystem::totalCellOn() {
+  if (unbounded) {
+    forWindow([this](int i, int j) { setCell(i, j, true); });
+    return;
+  }
+  fill(cells.begin(), cells.end(), ~0ULL);
+  for (int j = 0; j < numRows; j++) {
+    cells[j * wordsPerRow + wordsPerRow - 1] &= lastWordMask;
+  }
+  cellEdits++;
+  markAll();
+}
+//one column a tick, the same bit of every row
 void EntSystem::totalSideWipe() {
-  if(morph == true && morphT < cellGrid.size()) {
-    for(int i = 0; i < cellGrid[0].size(); i++) {
-      cellGrid[morphT][i].stateOff();
+  if(morph == true && morphT < numCols) {
+    for(int i = 0; i < numRows; i++) {
+      setCell(morphT, i, false);
     }
     morphT++;
   } else {
@@ -189,12 +372,447 @@ void EntSystem::totalSideWipe() {
   }
 }
 void EntSystem::totalDiagWipe() {
-  if(morph == true && morphT < cellGrid.size()) {
-    int i = ofClamp(morphT, 0, cellGrid[0].size()-1);
-    cellGrid[i][i].stateOn();
+  if(morph == true && morphT < numCols) {
+    int i = ofClamp(morphT, 0, numRows-1);
+    setCell(i, i, true);
     morphT++;
   } else {
     morph = false;
     morphT = 0;
   }
 }
+
+//CELL CHANGES, every change goes through here so the texture knows what to send
+//--------------------------------------------------------------
+bool EntSystem::getCell(int _col, int _row) const {
+  if (unbounded) {
+    return world.get(_col, _row);
+  }
+  return (cells[_row * wordsPerRow + (_col >> 6)] >> (_col & 63)) & 1;
+}
+
+bool EntSystem::cellAt(int _col, int _row) const {
+  if (!unbounded && (_col < 0 || _col >= numCols || _row < 0 || _row >= numRows)) {
+    return false;
+  }
+  return getCell(_col, _row);
+}
+
+//a change from outside the ticks, a cycle found before does not hold any more
+void EntSystem::flipCell(int _col, int _row) {
+  toggleCell(_col, _row);
+  cellEdits++;
+}
+
+void EntSystem::toggleCell(int _col, int _row) {
+  if (unbounded) {
+    world.flip(_col, _row);
+  } else {
+    cells[_row * wordsPerRow + (_col >> 6)] ^= 1ULL << (_col & 63);
+  }
+  markCell(_col, _row);
+}
+
+void EntSystem::setCell(int _col, int _row, bool _state) {
+  if (getCell(_col, _row) == _state) {
+    return;
+  }
+  flipCell(_col, _row);
+}
+
+//queues a cell for upload, the texture only shows the window of the grid
+void EntSystem::markCell(int _col, int _row) {
+  if (!useGL || texFull || _col < 0 || _col >= numCols || _row < 0 || _row >= numRows) {
+    return;
+  }
+  if (rowCol1[_row] < rowCol0[_row]) {
+    flippedRows.push_back(_row);
+  }
+  rowCol0[_row] = min(rowCol0[_row], _col);
+  rowCol1[_row] = max(rowCol1[_row], _col);
+}
+
+void EntSystem::markAll() {
+  for (int j : flippedRows) {
+    rowCol0[j] = numCols;
+    rowCol1[j] = -1;
+  }
+  flippedRows.clear();
+  texFull = useGL;
+}
+
+//sends the flipped rows, or the whole grid if most of it changed. rows close to each
+//other go as one block spanning all their cells, a few cells more saves a call
+void EntSystem::uploadCells() {
+  const int rowGap = 8;
+  vector<int> blocks; //x, y, w, h of every block
+  if (!texFull && !flippedRows.empty()) {
+    sort(flippedRows.begin(), flippedRows.end());
+    int area = 0;
+    int j0 = flippedRows[0];
+    int j1 = j0;
+    int i0 = rowCol0[j0];
+    int i1 = rowCol1[j0];
+    for (int k = 1; k <= flippedRows.size(); k++) {
+      int j = k < flippedRows.size() ? flippedRows[k] : INT_MAX;
+      if (j - j1 <= rowGap) {
+        j1 = j;
+        i0 = min(i0, rowCol0[j]);
+        i1 = max(i1, rowCol1[j]);
+        continue;
+      }
+      blocks.insert(blocks.end(), {i0, j0, i1 - i0 + 1, j1 - j0 + 1});
+      area += (i1 - i0 + 1) * (j1 - j0 + 1);
+      if (j < INT_MAX) {
+        j0 = j1 = j;
+        i0 = rowCol0[j];
+        i1 = rowCol1[j];
+      }
+    }
+    texFull = area > numCols * numRows / 2;
+  }
+
+  if (texFull) {
+    //texels of the whole grid, made from the bits and freed again after
+    cellPixels.allocate(numCols, numRows, 4);
+    unsigned char* p = cellPixels.getData();
+    for (int j = 0; j < numRows; j++) {
+      for (int i = 0; i < numCols; i++) {
+        const ofColor& col = getCell(i, j) ? cellOn : cellOff;
+        p[0] = col.r;
+        p[1] = col.g;
+        p[2] = col.b;
+        p[3] = 255;
+        p += 4;
+      }
+    }
+    cellTex.loadData(cellPixels);
+    cellPixels.clear();
+    texelsPatched += numCols * numRows;
+  } else if (!blocks.empty()) {
+    ofTextureData& td = cellTex.getTextureData();
+    glBindTexture(td.textureTarget, td.textureID);
+    for (int b = 0; b < blocks.size(); b += 4) {
+      int x = blocks[b];
+      int y = blocks[b + 1];
+      int w = blocks[b + 2];
+      int h = blocks[b + 3];
+      patch.resize(w * h * 4);
+      unsigned char* p = patch.data();
+      for (int j = y; j < y + h; j++) {
+        for (int i = x; i < x + w; i++) {
+          const ofColor& col = getCell(i, j) ? cellOn : cellOff;
+          p[0] = col.r;
+          p[1] = col.g;
+          p[2] = col.b;
+          p[3] = 255;
+          p += 4;
+        }
+      }
+      glTexSubImage2D(td.textureTarget, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, patch.data());
+      texelsPatched += w * h;
+    }
+    glBindTexture(td.textureTarget, 0);
+  }
+  markAll();
+  texFull = false;
+}
+
+//CYCLE DETECTION AND FAST FORWARD
+//--------------------------------------------------------------
+//the ents relative to the first one and the morph, a state moved over the grid
+//hashes the same
+uint64_t EntSystem::getStateHash() {
+  uint64_t h = mix64((uint64_t)morph << 32 | (uint32_t)morphT);
+  if (entArr.empty()) {
+    return h;
+  }
+  int col0 = entArr[0].col;
+  int row0 = entArr[0].row;
+  for (int i = 0; i < entArr.size(); i++) {
+    const Ent& e = entArr[i];
+    uint64_t pos = (uint64_t)(uint32_t)(e.col - col0) | (uint64_t)(uint32_t)(e.row - row0) << 32;
+    uint64_t mid = (uint64_t)(uint32_t)(e.midCol - col0) | (uint64_t)(uint32_t)(e.midRow - row0) << 32;
+    uint64_t rule = (uint64_t)e.dir | (uint64_t)e.state << 8 | (uint64_t)e.inv << 16 | (uint64_t)states[i] << 24;
+    h ^= mix64(mix64(mix64(pos ^ i) ^ mid) ^ rule);
+  }
+  return h;
+}
+
+//the 5 x 5 cells around every ent as they lie around it, a quick look before the
+//whole box is compared
+uint64_t EntSystem::getNearHash() {
+  uint64_t h = 0;
+  for (int i = 0; i < entArr.size(); i++) {
+    const Ent& e = entArr[i];
+    uint64_t bits = 0;
+    for (int y = -2; y <= 2; y++) {
+      for (int x = -2; x <= 2; x++) {
+        bits = bits << 1 | cellAt(e.midCol + x, e.midRow + y);
+      }
+    }
+    h ^= mix64(bits ^ (uint64_t)i << 32);
+  }
+  return h;
+}
+
+//forgets the checkpoint and the cycle, the next check starts over
+void EntSystem::resetCycles() {
+  checkPower = 0;
+  checkTick = tick;
+  check.hash = 0;
+  cyclePeriod = 0;
+  shiftCol = 0;
+  shiftRow = 0;
+}
+
+//the cycle is over, the checkpoint stays and the search goes on from it
+void EntSystem::endCycle() {
+  cyclePeriod = 0;
+  shiftCol = 0;
+  shiftRow = 0;
+}
+
+//the cells the next tick acts on are added to the ones since the checkpoint
+void EntSystem::visitEnts() {
+  for (const Ent& e : entArr) {
+    visitCol0 = min(visitCol0, e.midCol);
+    visitRow0 = min(visitRow0, e.midRow);
+    visitCol1 = max(visitCol1, e.midCol);
+    visitRow1 = max(visitRow1, e.midRow);
+  }
+}
+
+//a cell as it was at the checkpoint, -1 if it was not copied
+int EntSystem::snapCell(int _col, int _row) const {
+  int c = _col - check.col0;
+  int r = _row - check.row0;
+  if (c < 0 || c >= check.cols || r < 0 || r >= check.rows) {
+    return -1;
+  }
+  int words = (check.cols + 63) / 64;
+  return (check.cells[r * words + (c >> 6)] >> (c & 63)) & 1;
+}
+
+//the box of the first period moved by _col, _row is on the grid, always when unbounded
+bool EntSystem::boxOnGrid(int _col, int _row) const {
+  if (unbounded) {
+    return true;
+  }
+  return boxCol + _col >= 0 && boxRow + _row >= 0 &&
+         boxCol + _col + boxCols <= numCols && boxRow + _row + boxRows <= numRows;
+}
+
+//the period that starts _periods after the checkpoint is the first one moved that
+//many times: it stays off the edges and the cells it walks into, where the period
+//before left nothing, are the ones the first started on
+bool EntSystem::periodRepeats(int64_t _periods) {
+  if (shiftCol == 0 && shiftRow == 0) {
+    return true;
+  }
+  int dc = (int)(_periods * shiftCol);
+  int dr = (int)(_periods * shiftRow);
+  if (!boxOnGrid(dc, dr) || !boxOnGrid(dc + shiftCol, dr + shiftRow)) {
+    return false;
+  }
+  for (int i : boxAhead) {
+    if (cellAt(boxCol + i % boxCols + dc, boxRow + i / boxCols + dr) != (bool)boxBefore[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//the ents are the ones of the checkpoint, all moved like the first one. every cell
+//acted on since, moved the same, has to be what it was at the checkpoint: inside
+//the box that is what the period left behind, outside it what the next walks into
+bool EntSystem::matchCycle() {
+  if (entArr.empty() || states != check.states) {
+    return false;
+  }
+  int dc = entArr[0].col - check.ents[0].col;
+  int dr = entArr[0].row - check.ents[0].row;
+  for (int i = 0; i < entArr.size(); i++) {
+    if (!sameEnt(entArr[i], check.ents[i], dc, dr)) {
+      return false;
+    }
+  }
+
+  boxCol = visitCol0;
+  boxRow = visitRow0;
+  boxCols = visitCol1 - visitCol0 + 1;
+  boxRows = visitRow1 - visitRow0 + 1;
+  if (dc == 0 && dr == 0 && !unbounded) {
+    //in place ents may wrap, what they do off the grid is the same every period
+    boxCol = max(visitCol0, 0);
+    boxRow = max(visitRow0, 0);
+    boxCols = max(min(visitCol1 + 1, numCols) - boxCol, 0);
+    boxRows = max(min(visitRow1 + 1, numRows) - boxRow, 0);
+  } else if (!boxOnGrid(0, 0) || !boxOnGrid(dc, dr)) {
+    return false;
+  }
+
+  boxBefore.resize(boxCols * boxRows);
+  boxAhead.clear();
+  boxFlips.clear();
+  for (int r = 0; r < boxRows; r++) {
+    for (int c = 0; c < boxCols; c++) {
+      int before = snapCell(boxCol + c, boxRow + r);
+      if (before < 0 || cellAt(boxCol + c + dc, boxRow + r + dr) != (bool)before) {
+        return false;
+      }
+      int i = c + r * boxCols;
+      boxBefore[i] = before;
+      if (c + dc < 0 || c + dc >= boxCols || r + dr < 0 || r + dr >= boxRows) {
+        boxAhead.push_back(i);
+      }
+      if (cellAt(boxCol + c, boxRow + r) != (bool)before) {
+        boxFlips.push_back(i);
+      }
+    }
+  }
+  shiftCol = dc;
+  shiftRow = dr;
+  return true;
+}
+
+//after every tick while detectCycles is on
+void EntSystem::checkCycle() {
+  uint64_t h = getStateHash();
+  if (cyclePeriod > 0) {
+    //a whole number of periods on the ents have to be the checkpoint again, if not
+    //something changed them from outside (rules, morph, keys) and the cycle is gone
+    bool aligned = (tick - checkTick) % cyclePeriod == 0;
+    if (aligned && (h != check.hash || cellEdits != check.edits)) {
+      resetCycles();
+    } else {
+      //the ents walk into something new, the checkpoint is kept for a longer cycle
+      if (aligned && !periodRepeats((tick - checkTick) / cyclePeriod)) {
+        endCycle();
+      }
+      visitEnts();
+      return;
+    }
+  }
+
+  if (checkPower > 0 && h == check.hash && cellEdits == check.edits && !morph &&
+      getNearHash() == check.nearHash && matchCycle()) {
+    cyclePeriod = tick - checkTick;
+    return;
+  }
+
+  //the checkpoint jumps to the current tick at 1, 2, 4, 8... ticks after the last
+  bool newCheck = checkPower == 0 || tick - checkTick >= checkPower;
+  if (newCheck) {
+    checkPower = checkPower == 0 ? 1 : checkPower * 2;
+    checkTick = tick;
+    check.hash = h;
+    check.nearHash = getNearHash();
+    check.edits = cellEdits;
+    check.ents = entArr;
+    check.states = states;
+    visitCol0 = INT_MAX;
+    visitRow0 = INT_MAX;
+    visitCol1 = INT_MIN;
+    visitRow1 = INT_MIN;
+  }
+  visitEnts();
+
+  //the cells as they are now, the whole grid or, in an unbounded world, a margin
+  //around the ents. a period that walks out of it is not found
+  if (newCheck) {
+    if (!unbounded) {
+      check.col0 = 0;
+      check.row0 = 0;
+      check.cols = numCols;
+      check.rows = numRows;
+      check.cells = cells;
+    } else {
+      const int margin = 64;
+      check.col0 = visitCol0 - margin;
+      check.row0 = visitRow0 - margin;
+      check.cols = visitCol1 - visitCol0 + 1 + 2 * margin;
+      check.rows = visitRow1 - visitRow0 + 1 + 2 * margin;
+      if ((int64_t)check.cols * check.rows > (1 << 22)) {
+        check.cols = 0;
+        check.rows = 0;
+      }
+      int words = (check.cols + 63) / 64;
+      check.cells.assign(words * check.rows, 0);
+      for (int r = 0; r < check.rows; r++) {
+        for (int c = 0; c < check.cols; c++) {
+          check.cells[r * words + (c >> 6)] |= (uint64_t)world.get(check.col0 + c, check.row0 + r) << (c & 63);
+        }
+      }
+    }
+  }
+}
+
+//SKIPS WHOLE PERIODS OF A CYCLE, from a tick a whole number of periods after
+//checkTick. in place the state stays as it is, shifted every period flips the cells
+//the first one flipped once more, moved, and the ents move with it. stops before the
+//first period that does not repeat, the cycle ends there. returns the periods skipped
+uint64_t EntSystem::skipPeriods(uint64_t _periods) {
+  uint64_t done = 0;
+  if (shiftCol == 0 && shiftRow == 0) {
+    done = _periods;
+  } else {
+    int64_t first = (tick - checkTick) / cyclePeriod;
+    for (; done < _periods && periodRepeats(first + done); done++) {
+      int dc = (int)((first + done) * shiftCol);
+      int dr = (int)((first + done) * shiftRow);
+      for (int i : boxFlips) {
+        toggleCell(boxCol + i % boxCols + dc, boxRow + i / boxCols + dr);
+      }
+    }
+    for (Ent& e : entArr) {
+      e.col += (int)done * shiftCol;
+      e.row += (int)done * shiftRow;
+      e.midCol += (int)done * shiftCol;
+      e.midRow += (int)done * shiftRow;
+    }
+    //the skipped periods acted on the box all the way along
+    if (done > 0) {
+      int dc = (int)((first + done - 1) * shiftCol);
+      int dr = (int)((first + done - 1) * shiftRow);
+      visitCol0 = min(visitCol0, boxCol + min(dc, 0));
+      visitRow0 = min(visitRow0, boxRow + min(dr, 0));
+      visitCol1 = max(visitCol1, boxCol + boxCols - 1 + max(dc, 0));
+      visitRow1 = max(visitRow1, boxRow + boxRows - 1 + max(dr, 0));
+    }
+  }
+  tick += done * cyclePeriod;
+  ticksSkipped += done * cyclePeriod;
+  if (done < _periods) {
+    endCycle();
+  }
+  return done;
+}
+
+//RUNS A NUMBER OF TICKS, once a cycle is found whole periods are skipped
+//the state after is the same as after that many updates. returns the ticks stepped
+uint64_t EntSystem::fastForward(uint64_t _ticks) {
+  if (!detectCycles) {
+    detectCycles = true;
+    resetCycles();
+  }
+  uint64_t end = tick + _ticks;
+  uint64_t stepped = 0;
+  while (tick < end) {
+    //only from a tick where the state is the checkpoint, it may have been changed
+    //from outside since the last update
+    if (cyclePeriod > 0 && (tick - checkTick) % cyclePeriod == 0 &&
+        (getStateHash() != check.hash || cellEdits != check.edits)) {
+      resetCycles();
+    }
+    if (cyclePeriod > 0 && (tick - checkTick) % cyclePeriod == 0) {
+      skipPeriods((end - tick) / cyclePeriod);
+      if (tick == end) {
+        break;
+      }
+    }
+    step();
+    stepped++;
+  }
+  return stepped;
+}
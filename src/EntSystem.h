@@ -1,9 +1,19 @@
 #pragma once
 #include "ofMain.h"
 #include "helpers.h"
-#include "Cell.h"
 #include "Ent.h"
+#include "WorkerPool.h"
+#include "TurmiteRules.h"
+#include "ChunkWorld.h"
 
+//a copy of everything the next ticks depend on, the cells of a box around the ents
+struct EntSnapshot {
+  int col0, row0, cols, rows; //the box, the whole grid when bounded
+  vector<uint64_t> cells; //rows of words like the grid
+  vector<Ent> ents;
+  vector<int> states;
+  uint64_t hash, nearHash, edits;
+};
 
 class EntSystem
 {
@@ -11,11 +21,17 @@ public:
     EntSystem();
     void setup(int _numCols, float _sz, int _numEnts, float _minX, float _minY, float _maxX, float _maxY);
     void update(int _flow);
+    void step();
+    const vector<int>& stepN(int _n);
+    void updateParallel();
+    void setThreads(int _numThreads);
     void display();
     void doChange(Ent& tempEnt, int idx);
+    bool turnEnt(Ent& tempEnt, int idx);
     int getStateTotal();
-    vector<int> calcFlowArr(int _flow);
-    vector<int> getStateArr();
+    const vector<int>& calcFlowArr(int _flow);
+    const vector<int>& getStateArr();
+    void setRules(const TurmiteRules<2>& _rules);
     void massRandomRules();
     void randomRules();
     void randomIndividRule(int idx);
@@ -25,13 +41,95 @@ public:
     void totalCellOn();
     void totalSideWipe();
     void totalDiagWipe();
+    bool getCell(int _col, int _row) const;
+    void flipCell(int _col, int _row);
+    void setCell(int _col, int _row, bool _state);
+    void markCell(int _col, int _row);
+    void markAll();
+    void uploadCells();
+    bool cellAt(int _col, int _row) const; //off the bounded grid is off
+    uint64_t getStateHash();
+    uint64_t getNearHash();
+    void resetCycles();
+    void checkCycle();
+    uint64_t skipPeriods(uint64_t _periods);
+    uint64_t fastForward(uint64_t _ticks);
 
     float sz, width, height;
     int numCols,numRows, numEnts, morphT;
     bool morph;
-    vector<vector<Cell>> cellGrid;
+    //CELLS, one bit per cell, rows of 64 bit words, bit c%64 of word c/64 is column c
+    vector<uint64_t> cells;
+    int wordsPerRow;
+    uint64_t lastWordMask; //columns actually in the last word of a row
+    ofColor cellOn, cellOff; //colours of all cells
+
+    //UNBOUNDED, set before setup. the cells are in the world instead, the ents do
+    //not wrap and the grid above is the window that is shown
+    bool unbounded;
+    ChunkWorld world;
+
+    //calls _f(col, row) for every cell of the window
+    template<class F>
+    void forWindow(F _f) {
+      for (int j = 0; j < numRows; j++) {
+        for (int i = 0; i < numCols; i++) {
+          _f(i, j);
+        }
+      }
+    }
     vector<Ent> entArr;
-    vector<int> states;
+    TurmiteRules<2> rules, rulesInv; //two colours, a cell is on or off
+    vector<int> states; //cell each ent wrote in the last tick
+    vector<int> stepStates; //what most ticks of the last update or stepN wrote
+    vector<uint64_t> onCounts, periodCounts; //ticks each ent wrote a set cell, in stepN
     vector<int> flowStates;
 
+    //PARALLEL STEPPING, ents are split into bands of rows by the cell they act on
+    WorkerPool pool;
+    int numThreads;
+    vector<vector<int>> bandEnts; //ents per band, in index order
+    vector<vector<int>> bandFlipped; //cells flipped per band, marked after the step
+
+    //GRID AS A TEXTURE, one texel per cell, only the rows with flipped cells are sent,
+    //each from the first to the last flipped cell in it
+    ofPixels cellPixels; //only while the whole grid is sent
+    ofTexture cellTex;
+    vector<int> flippedRows; //rows changed since the last upload
+    vector<int> rowCol0, rowCol1; //flipped span per row, empty while rowCol1 < rowCol0
+    vector<unsigned char> patch; //texels of one block of rows
+    bool useGL, texFull;
+    uint64_t texelsPatched;
+
+    //CYCLES, a tick only depends on the cells under the ents, the ents and the morph.
+    //a state that comes back, in place or shifted (an ent on a highway), repeats from
+    //there as long as the cells ahead are the ones the ents started on, shifted the
+    //same way. the state is hashed every tick relative to the first ent, so a shift
+    //hashes the same, and held against a checkpoint that moves ahead at doubling
+    //distances (brent). a match is checked over the cells right around the ents,
+    //then cell by cell over the box the ents acted on since, before it counts.
+    //a period is then skipped by flipping what the first flipped once more, shifted,
+    //and moving the ents. on a bounded grid the box has to stay inside, ents wrap at the edges
+    bool detectCycles;
+    uint64_t tick; //updates since setup
+    uint64_t cellEdits; //changes to the cells that were not made by a tick
+    uint64_t checkTick, checkPower;
+    EntSnapshot check;
+    int visitCol0, visitRow0, visitCol1, visitRow1; //cells acted on since the checkpoint
+    uint64_t cyclePeriod; //0 until a repeat was found, from checkTick on
+    int shiftCol, shiftRow; //per period, 0 0 for a repeat in place
+    int boxCol, boxRow, boxCols, boxRows; //cells acted on in the first period
+    vector<char> boxBefore; //those cells at checkTick
+    vector<int> boxAhead; //cells of the box that a period later nothing of the box lands on
+    vector<int> boxFlips; //cells of the box the period changed
+    uint64_t ticksSkipped;
+
+private:
+    void endCycle();
+    void visitEnts();
+    void toggleCell(int _col, int _row);
+    int snapCell(int _col, int _row) const;
+    bool boxOnGrid(int _col, int _row) const;
+    bool periodRepeats(int64_t _periods);
+    bool matchCycle();
 };
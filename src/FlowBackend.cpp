@@ -0,0 +1,193 @@
+/*
+ * OPTICAL FLOW BACKENDS
+ */
+
+#include "FlowBackend.h"
+#include <climits>
+
+FlowBackend::FlowBackend()
+{
+  lastMicros = 0;
+  avgMicros = 0;
+  frames = 0;
+}
+
+//the first frame after a reset only becomes the previous one
+void FlowBackend::calc(const cv::Mat& _gray) {
+  uint64_t start = ofGetElapsedTimeMicros();
+  if (prevGray.empty() || prevGray.size() != _gray.size()) {
+    flow.create(_gray.size(), CV_32FC2);
+    flow.setTo(0);
+  } else {
+    calcFlow(prevGray, _gray);
+  }
+  _gray.copyTo(prevGray);
+
+  lastMicros = ofGetElapsedTimeMicros() - start;
+  avgMicros = frames == 0 ? lastMicros.load() : (avgMicros * 15 + lastMicros) / 16;
+  frames++;
+}
+
+void FlowBackend::reset() {
+  prevGray = cv::Mat();
+  flow.setTo(0);
+}
+
+const cv::Mat& FlowBackend::getFlow() const {
+  return flow;
+}
+
+void FlowBackend::fillFlow(int _x, int _y, int _w, int _h, float _fx, float _fy) {
+  for (int y = _y; y < _y + _h; y++) {
+    cv::Vec2f* row = flow.ptr<cv::Vec2f>(y);
+    for (int x = _x; x < _x + _w; x++) {
+      row[x][0] = _fx;
+      row[x][1] = _fy;
+    }
+  }
+}
+
+//--------------------------------------------------------------
+FarnebackFlow::FarnebackFlow()
+{
+  pyramidScale = 0.5;
+  numLevels = 4;
+  windowSize = 8;
+  numIterations = 2;
+  polyN = 7;
+  polySigma = 1.5;
+  haveFlow = false;
+}
+
+void FarnebackFlow::reset() {
+  FlowBackend::reset();
+  haveFlow = false;
+}
+
+void FarnebackFlow::calcFlow(const cv::Mat& _prev, const cv::Mat& _curr) {
+  int flags = haveFlow ? cv::OPTFLOW_USE_INITIAL_FLOW : 0;
+  cv::calcOpticalFlowFarneback(_prev, _curr, flow, pyramidScale, numLevels, windowSize, numIterations, polyN, polySigma, flags);
+  haveFlow = true;
+}
+
+string FarnebackFlow::getName() {
+  return "farneback";
+}
+
+//--------------------------------------------------------------
+LKFlow::LKFlow()
+{
+  spacing = 8;
+  windowSize = 15;
+  maxLevel = 2;
+}
+
+//points that are lost count as not moving
+void LKFlow::calcFlow(const cv::Mat& _prev, const cv::Mat& _curr) {
+  int cols = _curr.cols / spacing;
+  int rows = _curr.rows / spacing;
+  if (points.size() != (size_t)(cols * rows)) {
+    points.clear();
+    for (int j = 0; j < rows; j++) {
+      for (int i = 0; i < cols; i++) {
+        points.push_back(cv::Point2f(i * spacing + spacing / 2, j * spacing + spacing / 2));
+      }
+    }
+  }
+  flow.setTo(0);
+  if (points.empty()) {
+    return;
+  }
+
+  cv::calcOpticalFlowPyrLK(_prev, _curr, points, found, status, err, cv::Size(windowSize, windowSize), maxLevel,
+                           cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 20, 0.03));
+
+  for (size_t k = 0; k < points.size(); k++) {
+    if (!status[k]) {
+      continue;
+    }
+    float fx = found[k].x - points[k].x;
+    float fy = found[k].y - points[k].y;
+    fillFlow((k % cols) * spacing, (k / cols) * spacing, spacing, spacing, fx, fy);
+  }
+}
+
+string LKFlow::getName() {
+  return "lk grid";
+}
+
+//--------------------------------------------------------------
+BlockFlow::BlockFlow()
+{
+  blockSize = 8;
+  searchRadius = 4;
+}
+
+//every block of the last frame is looked for around the same place in this one,
+//the best offset is refined to sub pixel with a parabola through its neighbours
+void BlockFlow::calcFlow(const cv::Mat& _prev, const cv::Mat& _curr) {
+  int bs = blockSize;
+  int r = searchRadius;
+  int span = 2 * r + 1;
+  int cols = _curr.cols / bs;
+  int rows = _curr.rows / bs;
+  sads.resize(span * span);
+  flow.setTo(0);
+
+  for (int by = 0; by < rows; by++) {
+    for (int bx = 0; bx < cols; bx++) {
+      int x0 = bx * bs;
+      int y0 = by * bs;
+      int best = INT_MAX;
+      int bestDx = 0;
+      int bestDy = 0;
+      for (int dy = -r; dy <= r; dy++) {
+        for (int dx = -r; dx <= r; dx++) {
+          int& sad = sads[(dy + r) * span + dx + r];
+          sad = INT_MAX;
+          if (x0 + dx < 0 || y0 + dy < 0 || x0 + dx + bs > _curr.cols || y0 + dy + bs > _curr.rows) {
+            continue;
+          }
+          int s = 0;
+          for (int y = 0; y < bs; y++) {
+            const unsigned char* p = _prev.ptr<unsigned char>(y0 + y) + x0;
+            const unsigned char* c = _curr.ptr<unsigned char>(y0 + y + dy) + x0 + dx;
+            for (int x = 0; x < bs; x++) {
+              s += abs(p[x] - c[x]);
+            }
+          }
+          sad = s;
+          //ties go to the smallest move, still blocks stay still
+          if (s < best || (s == best && abs(dx) + abs(dy) < abs(bestDx) + abs(bestDy))) {
+            best = s;
+            bestDx = dx;
+            bestDy = dy;
+          }
+        }
+      }
+
+      //offsets outside the frame have no sad, no refinement towards them
+      auto subPixel = [&](int _a, int _b) {
+        if (_a == INT_MAX || _b == INT_MAX) {
+          return 0.0f;
+        }
+        float d = _a - 2.0f * best + _b;
+        return d > 0 ? (_a - _b) / (2 * d) : 0.0f;
+      };
+      float fx = bestDx;
+      float fy = bestDy;
+      int c = (bestDy + r) * span + bestDx + r;
+      if (bestDx > -r && bestDx < r) {
+        fx += subPixel(sads[c - 1], sads[c + 1]);
+      }
+      if (bestDy > -r && bestDy < r) {
+        fy += subPixel(sads[c - span], sads[c + span]);
+      }
+      fillFlow(x0, y0, bs, bs, fx, fy);
+    }
+  }
+}
+
+string BlockFlow::getName() {
+  return "blocks";
+}
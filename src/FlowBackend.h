@@ -0,0 +1,93 @@
+/*
+ * OPTICAL FLOW BACKENDS
+ *
+ * ways to find how the image moved between two frames, all with the same result:
+ * a CV_32FC2 field the size of the frame (pixels moved per frame). the app only uses
+ * the average and a few zones, both from the one pass of FlowZones over the field.
+ * a dense field is often more than is needed, the cheaper backends work on blocks or
+ * a grid of points and fill the field a block at a time.
+ *
+ * FarnebackFlow  dense, every pixel. starts from the last field
+ * LKFlow         pyramidal lucas kanade on a grid of points
+ * BlockFlow      block matching by the sum of absolute differences, sub pixel
+ *
+ * frames are 8 bit grayscale. calc times every frame, the time is read by the
+ * app thread while the vision thread writes it.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxCv.h"
+
+class FlowBackend {
+
+public:
+    FlowBackend();
+    virtual ~FlowBackend() {}
+
+    void calc(const cv::Mat& _gray);
+    virtual void reset(); //the next frame has nothing to compare to, the flow is zero until then
+    virtual string getName() = 0;
+
+    const cv::Mat& getFlow() const;
+
+    std::atomic<uint64_t> lastMicros, avgMicros; //time of calc, the last one and averaged
+    uint64_t frames;
+
+protected:
+    //prev and curr are the same size, fills flow
+    virtual void calcFlow(const cv::Mat& _prev, const cv::Mat& _curr) = 0;
+    //the same vector over a rectangle of the field
+    void fillFlow(int _x, int _y, int _w, int _h, float _fx, float _fy);
+
+    cv::Mat prevGray, flow;
+};
+
+//--------------------------------------------------------------
+class FarnebackFlow : public FlowBackend {
+
+public:
+    FarnebackFlow();
+    void reset();
+    string getName();
+
+    //same defaults as ofxCv::FlowFarneback
+    double pyramidScale, polySigma;
+    int numLevels, windowSize, numIterations, polyN;
+
+protected:
+    void calcFlow(const cv::Mat& _prev, const cv::Mat& _curr);
+    bool haveFlow; //the last field is a start for the next
+};
+
+//--------------------------------------------------------------
+class LKFlow : public FlowBackend {
+
+public:
+    LKFlow();
+    string getName();
+
+    int spacing; //pixels between points, each point stands for a spacing x spacing block
+    int windowSize, maxLevel;
+
+protected:
+    void calcFlow(const cv::Mat& _prev, const cv::Mat& _curr);
+    vector<cv::Point2f> points, found;
+    vector<unsigned char> status;
+    vector<float> err;
+};
+
+//--------------------------------------------------------------
+class BlockFlow : public FlowBackend {
+
+public:
+    BlockFlow();
+    string getName();
+
+    int blockSize, searchRadius;
+
+protected:
+    void calcFlow(const cv::Mat& _prev, const cv::Mat& _curr);
+    vector<int> sads; //(2r+1)^2 per block
+};
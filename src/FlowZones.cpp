@@ -0,0 +1,129 @@
+/*
+ * FLOW ZONES
+ */
+
+#include "FlowZones.h"
+
+FlowZones::FlowZones()
+{
+  width = 0;
+  height = 0;
+  setup(1);
+}
+
+void FlowZones::setup(int _numZones) {
+  numZones = max(_numZones, 1);
+  zones.assign(numZones, FlowZone());
+  average = glm::vec2(0, 0);
+  width = 0; //columns are mapped again on the next field
+}
+
+void FlowZones::clear() {
+  zones.assign(numZones, FlowZone());
+  average = glm::vec2(0, 0);
+}
+
+int FlowZones::getZone(int _x) const {
+  return ofClamp(_x * numZones / max(width, 1), 0, numZones - 1);
+}
+
+//the column buffers follow the size of the field
+void FlowZones::resize(int _width, int _height) {
+  width = _width;
+  height = _height;
+  zoneOf.resize(width);
+  zoneCols.assign(numZones, 0);
+  for (int x = 0; x < width; x++) {
+    zoneOf[x] = getZone(x);
+    zoneCols[zoneOf[x]]++;
+  }
+  colX.resize(width);
+  colY.resize(width);
+  rowMag.resize(width);
+  rowBin.resize(width);
+  colHist.resize(width * 8);
+}
+
+//SPEED AND DIRECTION OF EVERY PIXEL IN A ROW, the vectors are added to their columns.
+//no branches and plain arrays so the compiler vectorises it, a bin is where in the
+//column histograms the speed adds up
+static void rowSpeeds(const float* _row, int _w, float* _cx, float* _cy, float* _mag, int* _bin) {
+  for (int x = 0; x < _w; x++) {
+    float fx = _row[x * 2];
+    float fy = _row[x * 2 + 1];
+    float ax = fabsf(fx);
+    float ay = fabsf(fy);
+    int steep = ay > ax;
+    float hi = steep ? ay : ax;
+    float lo = steep ? ax : ay;
+
+    //the sector from the signs and which axis is larger, no atan2
+    int sx = fx < 0;
+    int sy = fy < 0;
+    int quadrant = sy * 2 + (sx ^ sy);
+    _bin[x] = (quadrant * 2 + (steep ^ (quadrant & 1))) * _w + x;
+    //the length without sqrt (alpha max plus beta min), at most 4% off
+    _mag[x] = hi * 0.96043f + lo * 0.39782f;
+
+    _cx[x] += fx;
+    _cy[x] += fy;
+  }
+}
+
+//--------------------------------------------------------------
+//ONE PASS OVER THE FIELD
+void FlowZones::reduce(const cv::Mat& _flow) {
+  if (_flow.empty()) {
+    return;
+  }
+  if (_flow.cols != width || _flow.rows != height) {
+    resize(_flow.cols, _flow.rows);
+  }
+  fill(colX.begin(), colX.end(), 0.f);
+  fill(colY.begin(), colY.end(), 0.f);
+  fill(colHist.begin(), colHist.end(), 0.f);
+
+  float* cx = colX.data();
+  float* cy = colY.data();
+  float* ch = colHist.data();
+  float* rm = rowMag.data();
+  int* rb = rowBin.data();
+  int w = width;
+  for (int y = 0; y < height; y++) {
+    const float* row = _flow.ptr<float>(y);
+    rowSpeeds(row, w, cx, cy, rm, rb);
+    //the speeds into their directions, one add a pixel
+    for (int x = 0; x < w; x++) {
+      ch[rb[x]] += rm[x];
+    }
+  }
+
+  //COLUMNS INTO ZONES
+  for (FlowZone& z : zones) {
+    z = FlowZone();
+  }
+  double sumX = 0;
+  double sumY = 0;
+  for (int x = 0; x < w; x++) {
+    FlowZone& z = zones[zoneOf[x]];
+    z.mean.x += cx[x];
+    z.mean.y += cy[x];
+    for (int d = 0; d < 8; d++) {
+      z.hist[d] += ch[d * w + x];
+      z.magnitude += ch[d * w + x];
+    }
+    sumX += cx[x];
+    sumY += cy[x];
+  }
+  for (int i = 0; i < numZones; i++) {
+    FlowZone& z = zones[i];
+    float pixels = max(zoneCols[i] * height, 1);
+    float total = z.magnitude;
+    z.mean /= pixels;
+    z.magnitude /= pixels;
+    for (float& h : z.hist) {
+      h = total > 0 ? h / total : 0;
+    }
+  }
+  average = glm::vec2(sumX, sumY) / (float)(width * height);
+}
@@ -0,0 +1,55 @@
+/*
+ * FLOW ZONES
+ *
+ * the flow field cut into columns across the image, one per shaft, and reduced in
+ * a single pass to what moved in each: the mean vector, the mean speed and how
+ * much of the speed went in each of 8 directions. the draft can answer to motion
+ * in every zone on its own instead of only the average of the whole frame.
+ *
+ * the pass sums every pixel column over all rows first. per row one loop without
+ * branches finds every pixels speed and direction, it runs over plain arrays so
+ * the compiler vectorises it, a second adds the speeds into the direction of each
+ * column, the one part that stays scalar. the columns are then added into their
+ * zones, which is only width steps. about the cost of averaging the field.
+ *
+ * directions are 45 degree sectors starting at +x and turning towards +y, in the
+ * image +y is down so 0 is right, 2 is down, 4 is left and 6 is up.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxCv.h"
+
+struct FlowZone {
+  glm::vec2 mean; //pixels moved per frame
+  float magnitude = 0; //mean speed, moves the other way in the zone do not cancel
+  float hist[8] = {0, 0, 0, 0, 0, 0, 0, 0}; //share of the speed per direction, sums to 1 if anything moved
+};
+
+class FlowZones {
+
+public:
+    FlowZones();
+
+    void setup(int _numZones);
+    void reduce(const cv::Mat& _flow); //CV_32FC2
+    void clear(); //nothing moved
+
+    //the zone an image column falls into
+    int getZone(int _x) const;
+
+    int numZones, width, height;
+    vector<FlowZone> zones;
+    glm::vec2 average; //of the whole frame, from the same pass
+
+private:
+    void resize(int _width, int _height);
+
+    vector<int> zoneOf; //per image column
+    vector<int> zoneCols; //image columns per zone
+    vector<float> colX, colY; //per image column, summed over the rows
+    vector<float> colHist; //direction * width + column, the speeds summed over the rows
+    vector<float> rowMag; //speed per pixel of the row
+    vector<int> rowBin; //where in colHist each pixel of the row adds up
+};
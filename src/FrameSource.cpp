@@ -0,0 +1,248 @@
+/*
+ * FRAME SOURCES FOR THE COMPUTER VISION
+ */
+
+#include "FrameSource.h"
+#include <random>
+
+FrameSource::FrameSource()
+{
+  realtime = true;
+  width = 0;
+  height = 0;
+  frameRate = 60;
+  frames = 0;
+  nextFrameMicros = 0;
+}
+
+ofPixels& FrameSource::getPixels() {
+  return pixels;
+}
+
+//one frame per frame period on a fixed schedule, a frame taken a little late does
+//not push the ones after it back. more than a period behind it starts over from now
+bool FrameSource::isDue() {
+  if (!realtime) {
+    return true;
+  }
+  uint64_t now = ofGetElapsedTimeMicros();
+  if (now < nextFrameMicros) {
+    return false;
+  }
+  uint64_t period = 1000000 / max(frameRate, 1);
+  nextFrameMicros += period;
+  if (nextFrameMicros + period < now) {
+    nextFrameMicros = now + period;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------
+bool CameraSource::setup(int _width, int _height, int _frameRate) {
+  width = _width;
+  height = _height;
+  frameRate = _frameRate;
+  realtime = true;
+  camera.setGrabber(std::make_shared<ofxPS3EyeGrabber>()); //COMMENT TO USE INTERNAL CAMERA
+  //    vidGrabber.setDeviceID(1);                                 //UNCOMMENT TO USE INTERNAL CAMERA
+  //    vidGrabber.setPixelFormat(OF_PIXELS_NATIVE);
+  camera.setDesiredFrameRate(frameRate);
+  bool ok = camera.initGrabber(width, height);
+  camera.getGrabber<ofxPS3EyeGrabber>()->setAutogain(false);
+  camera.getGrabber<ofxPS3EyeGrabber>()->setAutoWhiteBalance(false);
+  return ok;
+}
+
+bool CameraSource::update() {
+  camera.update();
+  if (!camera.isFrameNew()) {
+    return false;
+  }
+  frames++;
+  return true;
+}
+
+ofPixels& CameraSource::getPixels() {
+  return camera.getPixels();
+}
+
+string CameraSource::getName() {
+  return "ps3 eye";
+}
+
+//--------------------------------------------------------------
+VideoSource::VideoSource(string _path)
+{
+  path = _path;
+  nextImage = 0;
+}
+
+bool VideoSource::setup(int _width, int _height, int _frameRate) {
+  width = _width;
+  height = _height;
+  frameRate = _frameRate;
+  pixels.allocate(width, height, OF_PIXELS_RGB);
+
+  //a folder is an image sequence
+  ofDirectory dir(path);
+  if (dir.isDirectory()) {
+    dir.allowExt("png");
+    dir.allowExt("jpg");
+    dir.listDir();
+    dir.sort();
+    for (size_t i = 0; i < dir.size(); i++) {
+      images.push_back(dir.getPath(i));
+    }
+    return !images.empty();
+  }
+
+  //no texture, the player is read on the vision thread
+  player.setUseTexture(false);
+  if (!player.load(path)) {
+    return false;
+  }
+  player.setLoopState(OF_LOOP_NORMAL);
+  if (realtime) {
+    player.play();
+  } else {
+    player.setPaused(true);
+  }
+  return true;
+}
+
+bool VideoSource::update() {
+  if (!images.empty()) {
+    if (!isDue() || !ofLoadImage(loaded, images[nextImage])) {
+      return false;
+    }
+    nextImage = (nextImage + 1) % images.size();
+    fit(loaded);
+    return true;
+  }
+
+  //not realtime, every update steps the paused player on by one frame
+  if (!realtime) {
+    player.nextFrame();
+  }
+  player.update();
+  if (!player.isFrameNew()) {
+    return false;
+  }
+  fit(player.getPixels());
+  return true;
+}
+
+//rgb at the size of the source
+void VideoSource::fit(const ofPixels& _frame) {
+  pixels = _frame;
+  pixels.setImageType(OF_IMAGE_COLOR);
+  if ((int)pixels.getWidth() != width || (int)pixels.getHeight() != height) {
+    pixels.resize(width, height);
+  }
+  frames++;
+}
+
+string VideoSource::getName() {
+  return images.empty() ? "video " + path : "images " + path;
+}
+
+//--------------------------------------------------------------
+SyntheticSource::SyntheticSource(int _numBlobs, int _seed)
+{
+  numBlobs = _numBlobs;
+  seed = _seed;
+}
+
+bool SyntheticSource::setup(int _width, int _height, int _frameRate) {
+  width = _width;
+  height = _height;
+  frameRate = _frameRate;
+
+  //own generator, the blobs do not depend on or change ofRandom
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> unit(0, 1);
+
+  //BACKGROUND, fixed noise so still parts have texture and no flow
+  background.allocate(width, height, OF_PIXELS_RGB);
+  unsigned char* p = background.getData();
+  for (size_t i = 0; i < background.size(); i += 3) {
+    unsigned char v = 40 + (unsigned char)(unit(rng) * 40);
+    p[i] = v;
+    p[i + 1] = v;
+    p[i + 2] = v;
+  }
+
+  //BLOBS, speeds of up to 4 pixels a frame, in any direction
+  blobs.clear();
+  for (int i = 0; i < numBlobs; i++) {
+    Blob b;
+    b.pos = glm::vec2(unit(rng) * width, unit(rng) * height);
+    float angle = unit(rng) * TWO_PI;
+    float speed = 1 + unit(rng) * 3;
+    b.vel = glm::vec2(cos(angle), sin(angle)) * speed;
+    b.radius = height * (0.08 + unit(rng) * 0.08);
+    blobs.push_back(b);
+  }
+  pixels = background;
+  return true;
+}
+
+bool SyntheticSource::update() {
+  if (!isDue()) {
+    return false;
+  }
+  for (Blob& b : blobs) {
+    b.pos += b.vel;
+    //bounce off the edges, the velocity stays known
+    if (b.pos.x < b.radius || b.pos.x > width - b.radius) {
+      b.vel.x = -b.vel.x;
+    }
+    if (b.pos.y < b.radius || b.pos.y > height - b.radius) {
+      b.vel.y = -b.vel.y;
+    }
+  }
+  render();
+  frames++;
+  return true;
+}
+
+//a checker texture fixed to the blob, so it moves with it
+void SyntheticSource::render() {
+  memcpy(pixels.getData(), background.getData(), background.size());
+  unsigned char* p = pixels.getData();
+  for (const Blob& b : blobs) {
+    int x0 = max((int)(b.pos.x - b.radius), 0);
+    int x1 = min((int)(b.pos.x + b.radius) + 1, width);
+    int y0 = max((int)(b.pos.y - b.radius), 0);
+    int y1 = min((int)(b.pos.y + b.radius) + 1, height);
+    float r2 = b.radius * b.radius;
+    for (int y = y0; y < y1; y++) {
+      float dy = y - b.pos.y;
+      for (int x = x0; x < x1; x++) {
+        float dx = x - b.pos.x;
+        if (dx * dx + dy * dy > r2) {
+          continue;
+        }
+        float t = sin(dx * 0.4) * sin(dy * 0.4);
+        unsigned char v = 150 + (unsigned char)(t * 100);
+        unsigned char* px = p + (y * width + x) * 3;
+        px[0] = v;
+        px[1] = v;
+        px[2] = v;
+      }
+    }
+  }
+}
+
+//every blob moves its area at its velocity, the rest stands still
+glm::vec2 SyntheticSource::getMeanFlow() {
+  glm::vec2 sum(0, 0);
+  for (const Blob& b : blobs) {
+    sum += b.vel * (PI * b.radius * b.radius);
+  }
+  return sum / (float)(width * height);
+}
+
+string SyntheticSource::getName() {
+  return "synthetic, " + ofToString(numBlobs) + " blobs";
+}
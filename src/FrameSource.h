@@ -0,0 +1,97 @@
+/*
+ * FRAME SOURCES FOR THE COMPUTER VISION
+ *
+ * where ThreadedCV gets its images from: the ps3 eye camera, a video file or a
+ * folder of images, or made up moving blobs with known velocities. all of them
+ * give rgb frames of the size asked for in setup.
+ *
+ * a source that is not realtime hands out a new frame on every update, so the
+ * vision runs as fast as it can, faster than the camera would. realtime files and
+ * blobs keep to the frame rate like the camera does.
+ *
+ * update and getPixels are called from the vision thread only.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxPS3EyeGrabber.h"
+
+class FrameSource {
+
+public:
+    FrameSource();
+    virtual ~FrameSource() {}
+
+    virtual bool setup(int _width, int _height, int _frameRate) = 0;
+    virtual bool update() = 0; //true if there is a new frame
+    virtual string getName() = 0;
+    virtual ofPixels& getPixels();
+
+    bool realtime; //set before setup
+    int width, height, frameRate;
+    uint64_t frames; //frames handed out
+
+protected:
+    bool isDue(); //for sources that keep to the frame rate themselves
+    ofPixels pixels;
+    uint64_t nextFrameMicros;
+};
+
+//--------------------------------------------------------------
+//THE PS3 EYE, always realtime
+class CameraSource : public FrameSource {
+
+public:
+    bool setup(int _width, int _height, int _frameRate);
+    bool update();
+    string getName();
+    ofPixels& getPixels(); //the grabbers own buffer, not copied
+
+    ofVideoGrabber camera;
+};
+
+//--------------------------------------------------------------
+//A VIDEO FILE OR A FOLDER OF IMAGES, in name order, both loop
+class VideoSource : public FrameSource {
+
+public:
+    VideoSource(string _path);
+    bool setup(int _width, int _height, int _frameRate);
+    bool update();
+    string getName();
+
+    string path;
+    ofVideoPlayer player;
+    vector<string> images; //empty for a video
+    size_t nextImage;
+
+private:
+    void fit(const ofPixels& _frame);
+    ofPixels loaded;
+};
+
+//--------------------------------------------------------------
+//BLOBS WITH KNOWN VELOCITIES, a textured disc per blob over a fixed noise background.
+//the texture moves with the blob so the flow inside it is its velocity
+class SyntheticSource : public FrameSource {
+
+public:
+    struct Blob {
+      glm::vec2 pos, vel; //pixels, pixels per frame
+      float radius;
+    };
+
+    SyntheticSource(int _numBlobs = 3, int _seed = 1);
+    bool setup(int _width, int _height, int _frameRate);
+    bool update();
+    string getName();
+    glm::vec2 getMeanFlow(); //velocity averaged over the whole frame, what the average flow should be
+
+    int numBlobs, seed;
+    vector<Blob> blobs;
+
+private:
+    void render();
+    ofPixels background;
+};
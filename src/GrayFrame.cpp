@@ -0,0 +1,68 @@
+/*
+ * GRAY FRAME FOR THE OPTICAL FLOW
+ */
+
+#include "GrayFrame.h"
+
+GrayFrame::GrayFrame()
+{
+  factor = 4;
+  mirror = true;
+}
+
+void GrayFrame::setup(int _factor, bool _mirror) {
+  factor = max(_factor, 1);
+  mirror = _mirror;
+}
+
+//--------------------------------------------------------------
+//the rows of a block are added into colSums first, a plain add over the whole row
+//the compiler vectorises. the columns of every block are added up after that, once
+//per output row, and only the block sums are weighted to gray
+void GrayFrame::update(const ofPixels& _frame) {
+  int channels = _frame.getNumChannels();
+  if (channels != 1 && channels < 3) {
+    return;
+  }
+  int w = _frame.getWidth() / factor;
+  int h = _frame.getHeight() / factor;
+  if ((int)pixels.getWidth() != w || (int)pixels.getHeight() != h) {
+    pixels.allocate(w, h, OF_PIXELS_GRAY);
+    gray = ofxCv::toCv(pixels);
+  }
+  int rowValues = w * factor * channels;
+  colSums.resize(rowValues);
+
+  const unsigned char* src = _frame.getData();
+  size_t stride = _frame.getBytesStride();
+  uint16_t* cs = colSums.data();
+  int g = channels == 1 ? 0 : 1;
+  int b = channels == 1 ? 0 : 2;
+  uint32_t divisor = factor * factor * 256;
+  for (int oy = 0; oy < h; oy++) {
+    const unsigned char* row = src + oy * factor * stride;
+    for (int i = 0; i < rowValues; i++) {
+      cs[i] = row[i];
+    }
+    for (int dy = 1; dy < factor; dy++) {
+      row += stride;
+      for (int i = 0; i < rowValues; i++) {
+        cs[i] += row[i];
+      }
+    }
+
+    unsigned char* out = pixels.getData() + oy * w;
+    const uint16_t* block = cs;
+    for (int ox = 0; ox < w; ox++) {
+      uint32_t sr = 0;
+      uint32_t sg = 0;
+      uint32_t sb = 0;
+      for (int dx = 0; dx < factor; dx++, block += channels) {
+        sr += block[0];
+        sg += block[g];
+        sb += block[b];
+      }
+      out[mirror ? w - 1 - ox : ox] = (sr * 77 + sg * 150 + sb * 29 + divisor / 2) / divisor;
+    }
+  }
+}
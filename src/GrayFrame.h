@@ -0,0 +1,37 @@
+/*
+ * GRAY FRAME FOR THE OPTICAL FLOW
+ *
+ * turns a camera frame into what the flow is found in: a smaller, mirrored, 8 bit
+ * grayscale image. done in one pass, every source pixel is read once and only a
+ * row of sums and the small image are written, there are no colour images between.
+ * the same buffer is used every frame and the cv::Mat is only a header on it.
+ *
+ * every output pixel is the average of a factor x factor block, like an area
+ * resize, with the rgb weights of cv::COLOR_RGB2GRAY. the weights are applied to
+ * the sums of a block, not per source pixel, so it rounds once where opencv rounds
+ * twice and can be 1 off its result. the mirror is only where a pixel is written
+ * to. rgb, rgba and gray frames can be read, the remainder of a size that does not
+ * divide by the factor is left out.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ofxCv.h"
+
+class GrayFrame {
+
+public:
+    GrayFrame();
+
+    void setup(int _factor, bool _mirror);
+    void update(const ofPixels& _frame);
+
+    int factor;
+    bool mirror; //left and right swapped
+    ofPixels pixels; //the result, one channel
+    cv::Mat gray; //on the same memory
+
+private:
+    vector<uint16_t> colSums; //the source rows of a block added up, per value
+};
@@ -0,0 +1,137 @@
+/*
+ * MOTION GATE
+ */
+
+#include "MotionGate.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+MotionGate::MotionGate()
+{
+  enabled = true;
+  setup(2, 1, 60);
+}
+
+void MotionGate::setup(float _openLevel, float _closeLevel, int _holdFrames) {
+  openLevel = _openLevel;
+  closeLevel = min(_closeLevel, _openLevel);
+  holdFrames = max(_holdFrames, 1);
+  framesPassed = 0;
+  framesSkipped = 0;
+  reset();
+}
+
+void MotionGate::reset() {
+  prev.clear();
+  open = true;
+  energy = 0;
+  quietFrames = 0;
+}
+
+//--------------------------------------------------------------
+uint64_t MotionGate::sadScalar(const unsigned char* _a, const unsigned char* _b, size_t _n) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < _n; i++) {
+    sum += abs(_a[i] - _b[i]);
+  }
+  return sum;
+}
+
+uint64_t MotionGate::sad(const unsigned char* _a, const unsigned char* _b, size_t _n) {
+  size_t i = 0;
+  uint64_t sum = 0;
+#if defined(__SSE2__)
+  //psadbw sums the differences of 8 bytes into each 64 bit half
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 16 <= _n; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(_a + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(_b + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(a, b));
+  }
+  uint64_t halves[2];
+  _mm_storeu_si128((__m128i*)halves, acc);
+  sum = halves[0] + halves[1];
+#elif defined(__ARM_NEON)
+  //absolute differences, widened pairwise up to two 64 bit lanes
+  uint64x2_t acc = vdupq_n_u64(0);
+  for (; i + 16 <= _n; i += 16) {
+    uint8x16_t d = vabdq_u8(vld1q_u8(_a + i), vld1q_u8(_b + i));
+    acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(d)));
+  }
+  sum = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+  return sum + sadScalar(_a + i, _b + i, _n - i);
+}
+
+//--------------------------------------------------------------
+//THE ENERGY IS THE BUSIEST CELL, a person in a corner changes little of the whole
+//frame. cells are 16 x 8 pixels, a row of a cell is one simd step
+bool MotionGate::update(const ofPixels& _gray) {
+  int w = _gray.getWidth();
+  int h = _gray.getHeight();
+  if (_gray.getNumChannels() != 1 || (int)prev.getWidth() != w || (int)prev.getHeight() != h) {
+    prev = _gray;
+    open = true;
+    quietFrames = 0;
+    framesPassed++;
+    return true;
+  }
+
+  const int cellW = 16;
+  const int cellH = 8;
+  int numCells = (w + cellW - 1) / cellW;
+  cellSums.assign(numCells, 0);
+  const unsigned char* a = _gray.getData();
+  const unsigned char* b = prev.getData();
+  float busiest = 0;
+  for (int y = 0; y < h; y++) {
+    for (int c = 0; c < numCells; c++) {
+      int x = c * cellW;
+      cellSums[c] += sad(a + y * w + x, b + y * w + x, min(cellW, w - x));
+    }
+    //a band of cells is complete
+    if (y % cellH == cellH - 1 || y == h - 1) {
+      int rows = y % cellH + 1;
+      for (int c = 0; c < numCells; c++) {
+        float e = (float)cellSums[c] / (min(cellW, w - c * cellW) * rows);
+        busiest = max(busiest, e);
+        cellSums[c] = 0;
+      }
+    }
+  }
+  memcpy(prev.getData(), a, (size_t)w * h);
+  energy = busiest;
+
+  //HYSTERESIS
+  if (energy > openLevel) {
+    open = true;
+    quietFrames = 0;
+  } else if (energy < closeLevel) {
+    quietFrames++;
+    if (quietFrames >= holdFrames) {
+      open = false;
+    }
+  } else {
+    quietFrames = 0;
+  }
+
+  bool pass = open || !enabled;
+  if (pass) {
+    framesPassed++;
+  } else {
+    framesSkipped++;
+  }
+  return pass;
+}
+
+string MotionGate::getStats() {
+  uint64_t total = max(framesPassed + framesSkipped, (uint64_t)1);
+  stringstream ss;
+  ss << "gate: " << (enabled ? (open ? "open" : "closed") : "off") << ", " << framesSkipped.load() << " of " << total
+     << " frames skipped (" << 100 * framesSkipped / total << "%), energy " << energy.load();
+  return ss.str();
+}
@@ -0,0 +1,49 @@
+/*
+ * MOTION GATE
+ *
+ * decides before the optical flow if anything in the frame changed. most of the
+ * day nobody stands in front of the camera and the flow of a still room is zero,
+ * so it is not worth finding. the gray frame is compared to the one before, the
+ * energy is the mean absolute difference per pixel in gray levels, of the 16 x 8
+ * cell that changed most.
+ *
+ * the gate opens at once when the energy goes over openLevel and closes only after
+ * it stayed under closeLevel for holdFrames frames, so camera noise does not open
+ * it and a person standing still for a moment does not close it.
+ *
+ * the difference is summed 16 pixels at a time, with sse2 (psadbw) on x86, neon on
+ * arm boards that have it and plain c on the others (the armv6 pi).
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class MotionGate {
+
+public:
+    MotionGate();
+
+    void setup(float _openLevel, float _closeLevel, int _holdFrames);
+    bool update(const ofPixels& _gray); //true if the flow should run for this frame
+    void reset(); //open, the next frame is let through and becomes the one compared to
+    string getStats();
+
+    //sum of absolute differences of two byte arrays
+    static uint64_t sad(const unsigned char* _a, const unsigned char* _b, size_t _n);
+    static uint64_t sadScalar(const unsigned char* _a, const unsigned char* _b, size_t _n);
+
+    std::atomic<bool> enabled; //false lets every frame through, set by the app
+    float openLevel, closeLevel;
+    int holdFrames;
+
+    //read by the app for the stats
+    std::atomic<bool> open;
+    std::atomic<float> energy; //of the last frame
+    std::atomic<uint64_t> framesPassed, framesSkipped;
+    int quietFrames; //in a row under closeLevel
+
+private:
+    ofPixels prev;
+    vector<uint64_t> cellSums; //a band of cells
+};
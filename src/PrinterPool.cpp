@@ -0,0 +1,188 @@
+/*
+ * POOL OF THERMAL PRINTERS FED BY ONE DRAFT
+ *
+ * printers.txt (in bin/data) has one printer per line:
+ * port view [start length dotScale overflow]
+ * e.g.
+ * /dev/ttyUSB0 row
+ * /dev/ttyUSB1 repeat 0 10 7 coalesce
+ * virtual slice 20 25 14 drop
+ *
+ */
+
+#include "PrinterPool.h"
+
+PrinterPool::PrinterPool()
+{
+
+}
+
+PrinterPool::~PrinterPool()
+{
+  stop();
+}
+
+void PrinterPool::setup(const vector<PrinterConfig>& _configs) {
+  stop();
+  configs.clear();
+  printers.clear();
+  virtualPrinters.clear();
+
+  for (PrinterConfig c : _configs) {
+    //blocking would make the render loop wait for the slowest printer
+    if (c.overflow == PRINT_BLOCK) {
+      ofLogWarning("PrinterPool") << c.portName << ": blocking is not allowed in a pool, coalescing instead";
+      c.overflow = PRINT_COALESCE;
+    }
+
+    //stand-in printer on a pseudo-terminal, left out of the pool if there is none
+    string portName = c.portName;
+    unique_ptr<VirtualPrinter> virtualPrinter;
+    if (portName == "virtual") {
+      virtualPrinter.reset(new VirtualPrinter());
+      if (!virtualPrinter->setup(384, 4096, 1.0)) {
+        ofLogError("PrinterPool") << "could not open a virtual printer, skipped";
+        continue;
+      }
+      portName = virtualPrinter->getPortName();
+    }
+    configs.push_back(c);
+    virtualPrinters.push_back(std::move(virtualPrinter));
+
+    printers.push_back(unique_ptr<ThreadedPrinter>(new ThreadedPrinter()));
+    ThreadedPrinter& p = *printers.back();
+    p.setReverse(false);
+    p.setBold(true);
+    p.setAlign(ALIGN_MIDDLE);
+    p.setControlParameter(7,160,0);
+    p.setup(portName, c.queueSize, c.overflow);
+  }
+  views.resize(configs.size());
+}
+
+//READ THE POOL FROM A TEXT FILE, false if there is no file or no printer in it
+bool PrinterPool::setupFromFile(string _path) {
+  if (!ofFile::doesFileExist(_path)) {
+    return false;
+  }
+
+  vector<PrinterConfig> tempConfigs;
+  ofBuffer buffer = ofBufferFromFile(_path);
+  for (auto line : buffer.getLines()) {
+    vector<string> words = ofSplitString(line, " ", true, true);
+    if (words.empty() || words[0][0] == '#') {
+      continue;
+    }
+
+    PrinterConfig c;
+    c.portName = words[0];
+    if (words.size() > 1) {
+      c.view = words[1] == "repeat" ? VIEW_REPEAT : words[1] == "slice" ? VIEW_SLICE : VIEW_ROW;
+    }
+    if (words.size() > 2) c.start = ofToInt(words[2]);
+    if (words.size() > 3) c.length = ofToInt(words[3]);
+    if (words.size() > 4) c.dotScale = ofToInt(words[4]);
+    if (words.size() > 5) {
+      c.overflow = words[5] == "drop" ? PRINT_DROP : PRINT_COALESCE;
+    }
+    tempConfigs.push_back(c);
+  }
+
+  if (tempConfigs.empty()) {
+    return false;
+  }
+  setup(tempConfigs);
+  return true;
+}
+
+//main thread, every frame
+void PrinterPool::update() {
+  for (auto& p : printers) {
+    p->update();
+  }
+}
+
+void PrinterPool::stop() {
+  for (auto& p : printers) {
+    p->stop();
+  }
+  for (auto& v : virtualPrinters) {
+    if (v) {
+      v->stop();
+    }
+  }
+}
+
+//--------------------------------------------------------------
+//every printer gets its own view of the shed, queued on its own thread
+void PrinterPool::printRow(const vector<int>& _shed) {
+  for (size_t i = 0; i < printers.size(); i++) {
+    makeView(i, _shed);
+    printers[i]->printRow(views[i], configs[i].dotScale);
+  }
+}
+
+//a band of sheds, every printer gets its own view of every row in one job
+void PrinterPool::printRows(const vector<int>& _cells, int _numWarps) {
+  if (_numWarps <= 0) {
+    return;
+  }
+  int numRows = (int)_cells.size() / _numWarps;
+  vector<int> shed(_numWarps);
+
+  for (size_t i = 0; i < printers.size(); i++) {
+    band.clear();
+    for (int r = 0; r < numRows; r++) {
+      shed.assign(_cells.begin() + r * _numWarps, _cells.begin() + (r + 1) * _numWarps);
+      makeView(i, shed);
+      band.insert(band.end(), views[i].begin(), views[i].end());
+    }
+    printers[i]->printRows(band, (int)views[i].size(), configs[i].dotScale);
+  }
+}
+
+void PrinterPool::println(string _text) {
+  for (auto& p : printers) {
+    p->println(_text);
+  }
+}
+
+int PrinterPool::size() {
+  return (int)printers.size();
+}
+
+void PrinterPool::makeView(int _idx, const vector<int>& _shed) {
+  const PrinterConfig& c = configs[_idx];
+  vector<int>& view = views[_idx];
+  int numWarps = (int)_shed.size();
+  if (numWarps == 0) {
+    view.clear();
+    return;
+  }
+
+  int start = ofClamp(c.start, 0, numWarps - 1);
+  int length = c.length > 0 ? min(c.length, numWarps - start) : numWarps - start;
+
+  if (c.view == VIEW_REPEAT) {
+    //block of warps repeated over the full width
+    view.resize(numWarps);
+    for (int i = 0; i < numWarps; i++) {
+      view[i] = _shed[start + i % length];
+    }
+  } else if (c.view == VIEW_SLICE) {
+    view.assign(_shed.begin() + start, _shed.begin() + start + length);
+  } else {
+    view = _shed;
+  }
+}
+
+string PrinterPool::getStats() {
+  stringstream ss;
+  for (size_t i = 0; i < printers.size(); i++) {
+    ss << i << ": " << configs[i].portName << " " << printers[i]->getStats() << endl;
+    if (virtualPrinters[i]) {
+      ss << "   " << virtualPrinters[i]->getStats() << endl;
+    }
+  }
+  return ss.str();
+}
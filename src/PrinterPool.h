@@ -0,0 +1,65 @@
+/*
+ * POOL OF THERMAL PRINTERS FED BY ONE DRAFT
+ *
+ * every printer in the pool has its own port, its own writer thread (ThreadedPrinter),
+ * its own queue and encoder cache, and prints its own view of the current shed:
+ *
+ * VIEW_ROW - the full row
+ * VIEW_REPEAT - a block of warps repeated over the full width
+ * VIEW_SLICE - a slice of the warps, on its own
+ *
+ * a printer that is slow or stalled only fills its own queue, the others and the
+ * render loop do not wait for it. ports named "virtual" get a VirtualPrinter each.
+ *
+ * the pool prints next to the main printer of the app, so its ports should not
+ * include the one the main printer uses.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "ThreadedPrinter.h"
+#include "VirtualPrinter.h"
+
+enum PrintView {
+  VIEW_ROW,
+  VIEW_REPEAT,
+  VIEW_SLICE
+};
+
+struct PrinterConfig {
+  string portName = "virtual";
+  PrintView view = VIEW_ROW;
+  int start = 0; //first warp of the repeat block or slice
+  int length = 0; //number of warps in the repeat block or slice, 0 = all
+  int dotScale = 7;
+  int queueSize = 8;
+  PrintOverflow overflow = PRINT_COALESCE;
+};
+
+class PrinterPool {
+
+public:
+    PrinterPool();
+    ~PrinterPool();
+
+    void setup(const vector<PrinterConfig>& _configs);
+    bool setupFromFile(string _path);
+    void update();
+    void stop();
+
+    void printRow(const vector<int>& _shed);
+    void printRows(const vector<int>& _cells, int _numWarps);
+    void println(string _text);
+    int size();
+    string getStats();
+
+    vector<PrinterConfig> configs;
+    vector<unique_ptr<ThreadedPrinter>> printers;
+    vector<unique_ptr<VirtualPrinter>> virtualPrinters; //empty where the port is real
+
+private:
+    void makeView(int _idx, const vector<int>& _shed);
+    vector<vector<int>> views; //view row per printer, reused
+    vector<int> band; //view of a band, reused
+};
@@ -0,0 +1,200 @@
+/*
+ * ESC/POS RASTER ENCODER FOR THE THERMAL PRINTER
+ *
+ * raster images are sent as DC2 * r n followed by r lines of n bytes,
+ * the same bit image command the Adafruit style printers (and ofxThermalPrinter) use.
+ * the most significant bit of every byte is the leftmost dot.
+ *
+ */
+
+#include "RasterEncoder.h"
+
+//--------------------------------------------------------------
+//ESC/POS COMMANDS
+void escPosInit(vector<unsigned char>& _out) {
+  _out.push_back(27); //ESC @
+  _out.push_back(64);
+}
+
+void escPosControlParameter(vector<unsigned char>& _out, int _heatingDots, int _heatingTime, int _heatingInterval) {
+  _out.push_back(27); //ESC 7 n1 n2 n3
+  _out.push_back(55);
+  _out.push_back((unsigned char)_heatingDots);
+  _out.push_back((unsigned char)_heatingTime);
+  _out.push_back((unsigned char)_heatingInterval);
+}
+
+void escPosBold(vector<unsigned char>& _out, bool _state) {
+  _out.push_back(27); //ESC E n
+  _out.push_back(69);
+  _out.push_back(_state ? 1 : 0);
+}
+
+void escPosReverse(vector<unsigned char>& _out, bool _state) {
+  _out.push_back(29); //GS B n
+  _out.push_back(66);
+  _out.push_back(_state ? 1 : 0);
+}
+
+void escPosAlign(vector<unsigned char>& _out, int _align) {
+  _out.push_back(27); //ESC a n, 0 = left, 1 = middle, 2 = right
+  _out.push_back(97);
+  _out.push_back((unsigned char)_align);
+}
+
+void escPosFeed(vector<unsigned char>& _out, int _dots) {
+  while (_dots > 0) {
+    int n = min(_dots, 255);
+    _out.push_back(27); //ESC J n, feed n dot lines
+    _out.push_back(74);
+    _out.push_back((unsigned char)n);
+    _dots -= n;
+  }
+}
+
+void escPosText(vector<unsigned char>& _out, const string& _text) {
+  _out.insert(_out.end(), _text.begin(), _text.end());
+  _out.push_back(10); //LF
+}
+
+//--------------------------------------------------------------
+RasterEncoder::RasterEncoder()
+{
+  maxCacheSize = 4096;
+  cacheHits = 0;
+  cacheMisses = 0;
+  setup(384, 7);
+}
+
+void RasterEncoder::setup(int _printerDots, int _dotScale, int _printWidth) {
+  printerDots = _printerDots;
+  maxBytes = printerDots / 8;
+  dotScale = max(_dotScale, 1);
+  printWidth = max(_printWidth, 0);
+  bytesPerLine = 0;
+  cache.clear();
+}
+
+//--------------------------------------------------------------
+//PACKED DOT LINE OF A SHED, cached. blank sheds give an empty line
+const vector<unsigned char>& RasterEncoder::encodeLine(const int* _shed, int _numWarps) {
+  //pack the shed into bits as the cache key
+  key.assign((_numWarps + 7) / 8 + 1, 0);
+  key.back() = (char)(_numWarps & 0xff);
+  bool empty = true;
+  for (int i = 0; i < _numWarps; i++) {
+    if (_shed[i] > 0) {
+      key[i >> 3] |= (char)(0x80 >> (i & 7));
+      empty = false;
+    }
+  }
+  if (empty) {
+    return blank;
+  }
+
+  auto found = cache.find(key);
+  if (found != cache.end()) {
+    cacheHits++;
+    return found->second;
+  }
+  cacheMisses++;
+
+  //centre the row on the print head
+  int rowDots = printWidth > 0 ? printWidth : _numWarps * dotScale;
+  int w = min(rowDots, printerDots);
+  int leftPad = (printerDots - w) / 2;
+  bytesPerLine = min(maxBytes, (leftPad + w + 7) / 8);
+
+  vector<unsigned char> line(bytesPerLine, 0);
+  for (int i = 0; i < _numWarps; i++) {
+    if (_shed[i] <= 0) {
+      continue;
+    }
+    int x0 = leftPad + i * rowDots / _numWarps;
+    int x1 = min(leftPad + (i + 1) * rowDots / _numWarps, printerDots);
+    for (int x = x0; x < x1; x++) {
+      line[x >> 3] |= (unsigned char)(0x80 >> (x & 7));
+    }
+  }
+
+  return cache.emplace(key, std::move(line)).first->second;
+}
+
+//--------------------------------------------------------------
+//ROWS OF CELLS (numRows sheds of numWarps, one after the other) TO RASTER COMMANDS
+//all rows go under as few raster headers as possible (one per 255 dot lines),
+//blank rows are sent as a paper feed in between
+void RasterEncoder::appendRows(vector<unsigned char>& _out, const int* _cells, int _numWarps, int _numRows) {
+  if (cache.size() > maxCacheSize) {
+    cache.clear();
+  }
+
+  size_t header = 0; //position of the open raster header in _out
+  int lines = 0; //dot lines under the open header, 0 = no header open
+  int blankLines = 0;
+
+  for (int r = 0; r < _numRows; r++) {
+    const vector<unsigned char>& line = encodeLine(_cells + r * _numWarps, _numWarps);
+    if (line.empty()) {
+      blankLines += dotScale;
+      lines = 0; //the feed closes the raster
+      continue;
+    }
+    if (blankLines > 0) {
+      escPosFeed(_out, blankLines);
+      blankLines = 0;
+    }
+
+    for (int l = 0; l < dotScale; l++) {
+      if (lines == 0 || lines == 255) {
+        header = _out.size();
+        _out.push_back(18); //DC2 * r n
+        _out.push_back(42);
+        _out.push_back(0);
+        _out.push_back((unsigned char)line.size());
+        lines = 0;
+      }
+      _out.insert(_out.end(), line.begin(), line.end());
+      lines++;
+      _out[header + 2] = (unsigned char)lines;
+    }
+  }
+
+  if (blankLines > 0) {
+    escPosFeed(_out, blankLines);
+  }
+}
+
+//--------------------------------------------------------------
+//THRESHOLDED IMAGE TO RASTER COMMANDS, for anything that is not a shed
+void RasterEncoder::appendPixels(vector<unsigned char>& _out, const ofPixels& _pixels, int _threshold) {
+  int w = min((int)_pixels.getWidth(), printerDots);
+  int h = (int)_pixels.getHeight();
+  int ch = _pixels.getNumChannels();
+  int stride = (int)_pixels.getWidth() * ch;
+  int leftPad = (printerDots - w) / 2;
+  int n = min(maxBytes, (leftPad + w + 7) / 8);
+  const unsigned char* src = _pixels.getData();
+
+  int y = 0;
+  while (y < h) {
+    int r = min(h - y, 255);
+    _out.push_back(18); //DC2 * r n
+    _out.push_back(42);
+    _out.push_back((unsigned char)r);
+    _out.push_back((unsigned char)n);
+    for (int l = 0; l < r; l++, y++) {
+      size_t start = _out.size();
+      _out.resize(start + n, 0);
+      const unsigned char* row = src + y * stride;
+      for (int x = 0; x < w; x++) {
+        const unsigned char* p = row + x * ch;
+        int lum = ch >= 3 ? (p[0] + p[1] + p[2]) / 3 : p[0];
+        if (lum < _threshold) {
+          int dx = leftPad + x;
+          _out[start + (dx >> 3)] |= (unsigned char)(0x80 >> (dx & 7));
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,51 @@
+/*
+ * ESC/POS RASTER ENCODER FOR THE THERMAL PRINTER
+ *
+ * turns a shed (one row of the drawdown, 0/1 per warp) straight into packed
+ * 1-bit raster bytes, every warp becoming a dotScale x dotScale square of dots.
+ * with a print width the row is that many dots wide instead, warps spread over it
+ * with the fraction carried along (a 380 dot row of 50 warps is 7 or 8 dots a warp)
+ * and dotScale is only the height.
+ * no fbo, no readback, no thresholding of an image.
+ *
+ * the packed dot line of every distinct shed is cached, so a row that has been
+ * printed before costs a hash lookup. rows (repeated or not) are sent under a single
+ * raster header and blank rows as a paper feed instead of white dots.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+//ESC/POS COMMANDS, appended to an output buffer
+void escPosInit(vector<unsigned char>& _out);
+void escPosControlParameter(vector<unsigned char>& _out, int _heatingDots, int _heatingTime, int _heatingInterval);
+void escPosBold(vector<unsigned char>& _out, bool _state);
+void escPosReverse(vector<unsigned char>& _out, bool _state);
+void escPosAlign(vector<unsigned char>& _out, int _align);
+void escPosFeed(vector<unsigned char>& _out, int _dots);
+void escPosText(vector<unsigned char>& _out, const string& _text);
+
+class RasterEncoder {
+
+public:
+    RasterEncoder();
+
+    void setup(int _printerDots, int _dotScale, int _printWidth = 0);
+    const vector<unsigned char>& encodeLine(const int* _shed, int _numWarps);
+    void appendRows(vector<unsigned char>& _out, const int* _cells, int _numWarps, int _numRows);
+    void appendPixels(vector<unsigned char>& _out, const ofPixels& _pixels, int _threshold);
+
+    int printerDots; //width of the print head in dots, 384 on the 58mm printers
+    int maxBytes; //bytes per dot line of a full width line
+    int dotScale; //dots per warp, in both directions
+    int printWidth; //dots across a row, 0 = numWarps * dotScale
+    int bytesPerLine; //bytes actually sent per dot line, trimmed to the drawn width
+
+    //cache of packed dot lines, key is the shed packed into bits
+    unordered_map<string, vector<unsigned char>> cache;
+    string key;
+    vector<unsigned char> blank;
+    size_t maxCacheSize;
+    uint64_t cacheHits, cacheMisses;
+};
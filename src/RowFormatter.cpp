@@ -0,0 +1,110 @@
+/*
+ * TEXT FORMATTER FOR ROWS OF THE DRAFT
+ */
+
+#include "RowFormatter.h"
+
+RowFormatter::RowFormatter()
+{
+  rowsFormatted = 0;
+  rowsRefused = 0;
+  formatNanos = 0;
+  setup(50, 16, 0, GLYPHS_DIGITS);
+}
+
+void RowFormatter::setup(int _numWarps, int _batchRows, int _maxColumns, RowGlyphs _glyphs) {
+  numWarps = _numWarps;
+  batchRows = max(_batchRows, 1);
+  maxColumns = _maxColumns > 0 ? min(_maxColumns, numWarps) : numWarps;
+
+  const char* off = "0";
+  const char* on = "1";
+  if (_glyphs == GLYPHS_ASCII) {
+    off = " ";
+    on = "#";
+  } else if (_glyphs == GLYPHS_CP437) {
+    off = " ";
+    on = "\xDB";
+  } else if (_glyphs == GLYPHS_UTF8) {
+    off = " ";
+    on = "\xE2\x96\x88";
+  }
+  memset(glyph, 0, sizeof(glyph));
+  glyphLength[0] = (int)strlen(off);
+  glyphLength[1] = (int)strlen(on);
+  memcpy(glyph[0], off, glyphLength[0]);
+  memcpy(glyph[1], on, glyphLength[1]);
+
+  //room for a full batch of the widest glyphs + newlines, never grows after this
+  buffer.assign(batchRows * (maxColumns * 4 + 1), 0);
+  cells.assign(batchRows * maxColumns, 0);
+  rowColumns.assign(batchRows, 0);
+  clear();
+}
+
+//ADDS A ROW TO THE BATCH, true when the batch is full. a row that comes when the
+//batch is full and was not taken is refused, the batch is kept as it is
+bool RowFormatter::add(const vector<int>& _shed) {
+  if (rows >= batchRows) {
+    rowsRefused++;
+    return true;
+  }
+  //only on or off is kept, the text is made when the batch is read
+  unsigned char* on = cells.data() + rows * maxColumns;
+  int n = min(maxColumns, (int)_shed.size());
+  for (int i = 0; i < n; i++) {
+    on[i] = _shed[i] > 0;
+  }
+  rowColumns[rows] = n;
+  rows++;
+  return rows >= batchRows;
+}
+
+//FORMATS THE ROWS ADDED SINCE THE LAST READ INTO THE BUFFER, timed as one batch
+void RowFormatter::format() {
+  if (formattedRows >= rows) {
+    return;
+  }
+  auto t0 = chrono::steady_clock::now();
+
+  char* out = buffer.data() + length;
+  for (int r = formattedRows; r < rows; r++) {
+    const unsigned char* on = cells.data() + r * maxColumns;
+    for (int i = 0; i < rowColumns[r]; i++) {
+      memcpy(out, glyph[on[i]], 4);
+      out += glyphLength[on[i]];
+    }
+    *out++ = '\n';
+  }
+  length = out - buffer.data();
+
+  auto t1 = chrono::steady_clock::now();
+  formatNanos += chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+  rowsFormatted += rows - formattedRows;
+  formattedRows = rows;
+}
+
+const char* RowFormatter::getData() {
+  format();
+  return buffer.data();
+}
+
+size_t RowFormatter::getLength() {
+  format();
+  return length;
+}
+
+bool RowFormatter::isEmpty() {
+  return rows == 0;
+}
+
+void RowFormatter::clear() {
+  length = 0;
+  rows = 0;
+  formattedRows = 0;
+}
+
+//average cost of formatting one row
+double RowFormatter::getNanosPerRow() {
+  return rowsFormatted > 0 ? (double)formatNanos / rowsFormatted : 0;
+}
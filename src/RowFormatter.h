@@ -0,0 +1,57 @@
+/*
+ * TEXT FORMATTER FOR ROWS OF THE DRAFT
+ *
+ * formats sheds as text into a buffer that is allocated once, one line per row,
+ * and hands out many rows at a time so they can be sent with a single write.
+ * rows are kept as on/off until the batch is read, then all of them are formatted
+ * in one go. a full batch that was not taken is never overwritten, further rows
+ * are refused until it is cleared.
+ * used for the printer in text mode, logs and mirroring the print in a terminal.
+ *
+ * glyphs:
+ * GLYPHS_DIGITS - 0/1, like vectorToString
+ * GLYPHS_ASCII - # and space
+ * GLYPHS_CP437 - full block of the printers code page (0xDB) and space
+ * GLYPHS_UTF8 - full block (U+2588) and space, for terminals
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+enum RowGlyphs {
+  GLYPHS_DIGITS,
+  GLYPHS_ASCII,
+  GLYPHS_CP437,
+  GLYPHS_UTF8
+};
+
+class RowFormatter {
+
+public:
+    RowFormatter();
+
+    void setup(int _numWarps, int _batchRows, int _maxColumns, RowGlyphs _glyphs);
+    bool add(const vector<int>& _shed);
+    const char* getData();
+    size_t getLength();
+    bool isEmpty();
+    void clear();
+    double getNanosPerRow();
+
+    int numWarps, batchRows, maxColumns, rows;
+    uint64_t rowsFormatted, rowsRefused, formatNanos;
+
+private:
+    void format();
+
+    vector<unsigned char> cells; //on/off per row, maxColumns each
+    vector<int> rowColumns; //columns used per row
+    int formattedRows; //rows already in the buffer
+    vector<char> buffer;
+    size_t length;
+
+    //glyph for off [0] and on [1], at most 4 bytes each
+    char glyph[2][4];
+    int glyphLength[2];
+};
@@ -0,0 +1,227 @@
+/*
+ * SOFTWARE RASTERIZER FOR THE DRAFT, PATTERN AND ENTITY VIEWS
+ */
+
+#include "SoftRasterizer.h"
+#include "Draft.h"
+#include "EntSystem.h"
+
+//--------------------------------------------------------------
+void RasterGrid::setup(int _x, int _y, int _cols, int _rows, int _pitch, bool _lines) {
+  x = _x;
+  y = _y;
+  cols = max(_cols, 0);
+  rows = max(_rows, 0);
+  pitch = max(_pitch, 1);
+  lines = _lines;
+  valid = false;
+  pushes = 0;
+  shadow.assign(cols * rows, 2);
+}
+
+//sets up the grid again only if the layout changed
+static void fitGrid(RasterGrid& _g, int _x, int _y, int _cols, int _rows, int _pitch, bool _lines) {
+  if (_g.x != _x || _g.y != _y || _g.cols != _cols || _g.rows != _rows || _g.pitch != max(_pitch, 1) || _g.lines != _lines) {
+    _g.setup(_x, _y, _cols, _rows, _pitch, _lines);
+  }
+}
+
+//--------------------------------------------------------------
+SoftRasterizer::SoftRasterizer()
+{
+  width = 0;
+  height = 0;
+  useTexture = false;
+  dirty = false;
+  cellsPainted = 0;
+  rowsScrolled = 0;
+  uploads = 0;
+  for (RasterGrid* g : {&threading, &tieUp, &treadling, &drawDown, &pattern, &ents}) {
+    g->setup(0, 0, 0, 0, 1, false);
+  }
+}
+
+void SoftRasterizer::setup(int _width, int _height, bool _useTexture) {
+  width = _width;
+  height = _height;
+  useTexture = _useTexture;
+  pixels.allocate(width, height, 3);
+  if (useTexture) {
+    texture.allocate(pixels);
+    texture.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+  }
+  invalidate();
+}
+
+//clears the buffer, every view is painted in full next time
+void SoftRasterizer::invalidate() {
+  pixels.set(0);
+  for (RasterGrid* g : {&threading, &tieUp, &treadling, &drawDown, &pattern, &ents}) {
+    g->valid = false;
+  }
+  entCells.clear();
+  dirty = true;
+}
+
+//--------------------------------------------------------------
+//FILLS A RECTANGLE, the first row pixel by pixel, the rest copied from it
+void SoftRasterizer::fillRect(int _x, int _y, int _w, int _h, const ofColor& _c) {
+  int x0 = max(_x, 0);
+  int y0 = max(_y, 0);
+  int x1 = min(_x + _w, width);
+  int y1 = min(_y + _h, height);
+  if (x1 <= x0 || y1 <= y0) {
+    return;
+  }
+
+  size_t stride = width * 3;
+  size_t spanBytes = (x1 - x0) * 3;
+  unsigned char* first = pixels.getData() + y0 * stride + x0 * 3;
+  for (unsigned char* p = first; p < first + spanBytes; p += 3) {
+    p[0] = _c.r;
+    p[1] = _c.g;
+    p[2] = _c.b;
+  }
+  for (int y = y0 + 1; y < y1; y++) {
+    memcpy(first + (y - y0) * stride, first, spanBytes);
+  }
+  dirty = true;
+}
+
+//MOVES A PART OF THE BUFFER DOWN, the top _dy rows are left as they were
+void SoftRasterizer::shiftDown(int _x, int _y, int _w, int _h, int _dy) {
+  int x0 = max(_x, 0);
+  int x1 = min(_x + _w, width);
+  int top = max(_y, 0);
+  int bottom = min(_y + _h, height);
+  if (x1 <= x0 || _dy <= 0) {
+    return;
+  }
+
+  size_t stride = width * 3;
+  size_t spanBytes = (x1 - x0) * 3;
+  unsigned char* data = pixels.getData();
+  //from the bottom up so no row is overwritten before it is moved
+  for (int y = bottom - 1; y - _dy >= top; y--) {
+    memcpy(data + y * stride + x0 * 3, data + (y - _dy) * stride + x0 * 3, spanBytes);
+  }
+  dirty = true;
+}
+
+//padding around the part, edges and grid lines, 2 pixels wide like the gl grid
+void SoftRasterizer::paintFrame(RasterGrid& _g, const ofColor& _fg, const ofColor& _bg) {
+  int w = _g.cols * _g.pitch;
+  int h = _g.rows * _g.pitch;
+  fillRect(_g.x - 2, _g.y - 2, w + 4, h + 4, _bg);
+  for (int c = 0; c <= _g.cols; c++) {
+    fillRect(_g.x + c * _g.pitch - 1, _g.y - 1, 2, h + 2, _fg);
+  }
+  for (int r = 0; r <= _g.rows; r++) {
+    fillRect(_g.x - 1, _g.y + r * _g.pitch - 1, w + 2, 2, _fg);
+  }
+}
+
+//--------------------------------------------------------------
+//THE DRAFT, same layout as Draft::draw
+void SoftRasterizer::drawDraft(const Draft& _draft, int _x, int _y) {
+  int p = (int)_draft.cellSize;
+  int pad = (int)round(_draft.boxPad / _draft.cellSize);
+  int ox = _x + (int)round(_draft.orgX);
+  int oy = _y + (int)round(_draft.orgY);
+  int sideX = ox + (_draft.numWarps + pad) * p;
+  int lowY = oy + (_draft.numShafts + pad) * p;
+
+  fitGrid(threading, ox, oy, _draft.numWarps, _draft.numShafts, p, true);
+  fitGrid(tieUp, sideX, oy, _draft.numShafts, _draft.numShafts, p, true);
+  fitGrid(treadling, sideX, lowY, _draft.numShafts, _draft.numWeft, p, true);
+  fitGrid(drawDown, ox, lowY, _draft.numWarps, _draft.numWeft, p, true);
+
+  syncGrid(threading, 0, _draft.fg, _draft.bg, [&](int r, int c) {
+    return _draft.threadingSimple[c] == r;
+  });
+  syncGrid(tieUp, 0, _draft.fg, _draft.bg, [&](int r, int c) {
+    return _draft.tieUp[c][r] > 0;
+  });
+  syncGrid(treadling, _draft.treadlingPushes, _draft.fg, _draft.bg, [&](int r, int c) {
+    return _draft.treadling[r] == c;
+  });
+  syncGrid(drawDown, _draft.drawDownPushes, _draft.fg, _draft.bg, [&](int r, int c) {
+    return _draft.drawDown[r][c] == 1;
+  });
+}
+
+//THE DRAWDOWN ONLY, scaled to a width, like Draft::drawPattern
+void SoftRasterizer::drawPattern(const Draft& _draft, int _x, int _y, int _w) {
+  fitGrid(pattern, _x, _y, _draft.numWarps, _draft.numWeft, _w / max(_draft.numWarps, 1), false);
+  syncGrid(pattern, _draft.drawDownPushes, _draft.fg, _draft.bg, [&](int r, int c) {
+    return _draft.drawDown[r][c] == 1;
+  });
+}
+
+//THE CELLS AND ENTS, like EntSystem::display
+void SoftRasterizer::drawEnts(const EntSystem& _ents, int _x, int _y) {
+  int p = (int)_ents.sz;
+  fitGrid(ents, _x, _y, _ents.numCols, _ents.numRows, p, false);
+
+  //cells under last frames ents are painted again
+  for (int idx : entCells) {
+    if (ents.valid && idx < (int)ents.shadow.size()) {
+      ents.shadow[idx] = 2;
+    }
+  }
+  entCells.clear();
+
+  syncGrid(ents, 0, _ents.cellOn, _ents.cellOff, [&](int r, int c) {
+    return _ents.getCell(c, r);
+  });
+
+  for (const Ent& e : _ents.entArr) {
+    int c = e.col;
+    int r = e.row;
+    ofColor col = e.inv ? ofColor(99, 224, 139) : ofColor(224, 99, 139);
+    fillRect(_x + c * p, _y + r * p, p, p, col);
+    if (c >= 0 && c < ents.cols && r >= 0 && r < ents.rows) {
+      entCells.push_back(r * ents.cols + c);
+    }
+  }
+}
+
+//--------------------------------------------------------------
+//one texture upload per frame, only if something was painted
+void SoftRasterizer::upload() {
+  if (!useTexture || !dirty) {
+    return;
+  }
+  texture.loadData(pixels);
+  uploads++;
+  dirty = false;
+}
+
+void SoftRasterizer::draw(float _x, float _y) {
+  if (!useTexture) {
+    return;
+  }
+  ofSetColor(255);
+  texture.draw(_x, _y);
+}
+
+bool SoftRasterizer::save(string _path) {
+  return ofSaveImage(pixels, _path);
+}
+
+//FNV-1a over the buffer, to compare frames
+uint64_t SoftRasterizer::getChecksum() {
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char* data = pixels.getData();
+  for (size_t i = 0; i < pixels.size(); i++) {
+    h = (h ^ data[i]) * 1099511628211ULL;
+  }
+  return h;
+}
+
+string SoftRasterizer::getStats() {
+  stringstream ss;
+  ss << "raster: " << cellsPainted << " cells painted, " << rowsScrolled << " rows scrolled, "
+     << uploads << " uploads, checksum " << hex << getChecksum();
+  return ss.str();
+}
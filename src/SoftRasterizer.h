@@ -0,0 +1,105 @@
+/*
+ * SOFTWARE RASTERIZER FOR THE DRAFT, PATTERN AND ENTITY VIEWS
+ *
+ * draws the same views as Draft::draw, Draft::drawPattern and EntSystem::display
+ * into an ofPixels on the cpu, no opengl needed. used for headless runs, boards
+ * without a usable gpu and for saving pixel exact frames to compare.
+ *
+ * cells are filled a row span at a time. every view keeps the state of the cells
+ * already in the buffer and only repaints the ones that changed. when treadling,
+ * drawdown or pattern scroll, their part of the buffer is moved down by whole
+ * cell rows and only the new rows are painted.
+ *
+ * cells are a whole number of pixels (the cell size rounded down) so a scroll is
+ * an exact move of pixel rows, the views are a little smaller than the gl ones.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class Draft;
+class EntSystem;
+
+//a grid of cells in the buffer, the cell states it holds in row order
+struct RasterGrid {
+  void setup(int _x, int _y, int _cols, int _rows, int _pitch, bool _lines);
+
+  int x, y, cols, rows, pitch;
+  bool lines; //grid lines between the cells
+  bool valid; //false until the frame and all cells have been painted
+  uint64_t pushes; //rows scrolled in so far
+  vector<unsigned char> shadow; //0/1 per cell, 2 if it has to be painted
+};
+
+class SoftRasterizer {
+
+public:
+    SoftRasterizer();
+
+    void setup(int _width, int _height, bool _useTexture);
+    void invalidate();
+    void fillRect(int _x, int _y, int _w, int _h, const ofColor& _c);
+    void shiftDown(int _x, int _y, int _w, int _h, int _dy);
+
+    void drawDraft(const Draft& _draft, int _x, int _y);
+    void drawPattern(const Draft& _draft, int _x, int _y, int _w);
+    void drawEnts(const EntSystem& _ents, int _x, int _y);
+
+    void upload();
+    void draw(float _x, float _y);
+    bool save(string _path);
+    uint64_t getChecksum();
+    string getStats();
+
+    int width, height;
+    ofPixels pixels;
+    ofTexture texture;
+    bool useTexture, dirty;
+    uint64_t cellsPainted, rowsScrolled, uploads;
+
+    //views
+    RasterGrid threading, tieUp, treadling, drawDown, pattern, ents;
+    vector<int> entCells; //cells covered by ents last frame
+
+private:
+    void paintFrame(RasterGrid& _g, const ofColor& _fg, const ofColor& _bg);
+
+    //BRINGS A GRID UP TO DATE, isOn(row, col) gives the current state of a cell
+    template<class F>
+    void syncGrid(RasterGrid& _g, uint64_t _pushes, const ofColor& _fg, const ofColor& _bg, F _isOn) {
+      if (!_g.valid) {
+        if (_g.lines) {
+          paintFrame(_g, _fg, _bg);
+        }
+        fill(_g.shadow.begin(), _g.shadow.end(), 2);
+        _g.pushes = _pushes;
+        _g.valid = true;
+      } else if (_pushes != _g.pushes) {
+        uint64_t d = _pushes - _g.pushes;
+        if (d >= (uint64_t)_g.rows) {
+          fill(_g.shadow.begin(), _g.shadow.end(), 2);
+        } else {
+          //old rows move down, the top rows are painted below
+          shiftDown(_g.x, _g.y, _g.cols * _g.pitch, _g.rows * _g.pitch, (int)d * _g.pitch);
+          memmove(&_g.shadow[d * _g.cols], &_g.shadow[0], (_g.rows - d) * _g.cols);
+          rowsScrolled += d;
+        }
+        _g.pushes = _pushes;
+      }
+
+      int inset = _g.lines ? 1 : 0;
+      int size = _g.pitch - 2 * inset;
+      for (int r = 0; r < _g.rows; r++) {
+        unsigned char* s = &_g.shadow[r * _g.cols];
+        for (int c = 0; c < _g.cols; c++) {
+          unsigned char on = _isOn(r, c) ? 1 : 0;
+          if (s[c] != on) {
+            s[c] = on;
+            fillRect(_g.x + c * _g.pitch + inset, _g.y + r * _g.pitch + inset, size, size, on ? _fg : _bg);
+            cellsPainted++;
+          }
+        }
+      }
+    }
+};
@@ -20,25 +20,44 @@
 
 ThreadedCV::ThreadedCV()
 {
-
-  startThread();
+  frameRate = 60;
+  framesProcessed = 0;
+  wakeups = 0;
+  frameMicros = 0;
+
+  backends.push_back(unique_ptr<FlowBackend>(new FarnebackFlow()));
+  backends.push_back(unique_ptr<FlowBackend>(new LKFlow()));
+  backends.push_back(unique_ptr<FlowBackend>(new BlockFlow()));
+  backendIdx = 0;
+  curFlow = backends[0].get();
 }
 
 ThreadedCV::~ThreadedCV()
 {
-  waitForThread(true);
+  stop();
+}
+
+//wakes the thread if it is waiting for a frame and waits for it to end
+void ThreadedCV::stop() {
+  stopThread();
+  frameWait.notify_all();
+  waitForThread(false);
+}
+
+//another source than the camera, before setup
+void ThreadedCV::setSource(unique_ptr<FrameSource> _source) {
+  source = move(_source);
 }
 
 void ThreadedCV::setup(int _numShafts, int _numWarps) {
 
-  //    //CAMERA
-  camera.setGrabber(std::make_shared<ofxPS3EyeGrabber>()); //COMMENT TO USE INTERNAL CAMERA
-  //    vidGrabber.setDeviceID(1);                                 //UNCOMMENT TO USE INTERNAL CAMERA
-  //    vidGrabber.setPixelFormat(OF_PIXELS_NATIVE);
-  camera.setDesiredFrameRate(60);
-  camera.initGrabber(640, 480);
-  camera.getGrabber<ofxPS3EyeGrabber>()->setAutogain(false);
-  camera.getGrabber<ofxPS3EyeGrabber>()->setAutoWhiteBalance(false);
+  //CAMERA, or the source set before
+  if (!source) {
+    source.reset(new CameraSource());
+  }
+  if (!source->setup(640, 480, frameRate)) {
+    ofLogError("ThreadedCV") << "could not set up " << source->getName();
+  }
 
   cursorX = 0; //used for controling the treadling ie where the treadling is, influenced by movement in x axis
   counterY = 0; //counter used as lag or small delay to smoothen flip/trigger of bool
@@ -53,146 +72,239 @@ void ThreadedCV::setup(int _numShafts, int _numWarps) {
   damp = 0.05;
   yThresh = -10;
   traction = 2.0;
-  currentColor.allocate(640, 480);
-  float decimate = 0.25;
-  decimatedImage.allocate( currentColor.width * decimate, currentColor.height * decimate );
+  grayFrame.setup(4, true); //a quarter of the size, flipped like a mirror
+  gate.setup(2, 1, frameRate); //closes after a second without motion
+  gated = false;
 
 
-  curFlow = &fb;
   numShafts = _numShafts;
-  warpMovements.resize(29);
+  flowZones.setup(numShafts);
   avrgMove.resize(100);
+
+  //the thread only starts once the camera is set up, the app starts from these values
+  publish();
+  startThread();
 }
 
 
+//ONE PASS PER FRAME OF THE SOURCE
+//the grabber has no callback, between frames the thread sleeps half a frame at a
+//time (or until stop) instead of spinning. counters and lags are in frames.
+//a source that is not realtime always has a frame, the thread never sleeps
 void ThreadedCV::threadedFunction() {
-  camera.update();
-  ofPixels pixels;
+  auto halfFrame = std::chrono::microseconds(500000 / frameRate);
   while(isThreadRunning()) {
-    if(camera.isFrameNew()) {
-
-
-      //      //Reading pixles and convert to ofxCVImage
-      pixels = camera.getPixels();
-      currentColor.setFromPixels( pixels );
-
-      //Decimate images to 25%, a lot less expensive and lets you keep higher resolution camera input. Ref: Theo Papatheodorou see readme
-      decimatedImage.scaleIntoMe( currentColor, CV_INTER_AREA );
-      //FLIPPING THE IMAGE
-      decimatedImage.mirror(false,true);
-
-
-      curFlow->calcOpticalFlow(decimatedImage);
-      flow=fb.getAverageFlow() * multi; ///*~30?
-      flow=glm::vec2(flow.x,flow.y) ;
-      dampenedflow+=(flow-dampenedflow)*damp; //~.05
-      prev+=dampenedflow;
-
-      glm::vec2 midZone=glm::vec2(ofGetWidth()/2,ofGetHeight()/2);
-      glm::vec2 returnToMid = midZone-prev;
-      glm::vec2 norm = glm::normalize(returnToMid);
-      float dist = glm::distance(prev, midZone);
+    wakeups++;
+    if(!source->update()) {
+      std::unique_lock<std::mutex> lock(frameWaitMutex);
+      frameWait.wait_for(lock, halfFrame);
+      continue;
+    }
+    uint64_t frameStart = ofGetElapsedTimeMicros();
 
-      prev.x = ofClamp(prev.x, -100, ofGetWidth()+100);
+    //another backend was asked for, it starts over from this frame
+    FlowBackend* backend = backends[backendIdx].get();
+    if (backend != curFlow) {
+      curFlow = backend;
+      curFlow->reset();
+    }
 
-      //slight controllable traction/current
-      if(dist > 3) {
-        prev+=norm*(traction);
+    //Decimate images to 25%, a lot less expensive and lets you keep higher resolution camera input. Ref: Theo Papatheodorou see readme
+    //mirrored and gray in the same pass, straight from the sources buffer
+    grayFrame.update(source->getPixels());
+
+    //NOTHING MOVED, the flow is zero and not found. it still goes through the damping
+    //below so the cursor and motionDetected settle like they would on a zero flow
+    if (gate.update(grayFrame.pixels)) {
+      curFlow->calc(grayFrame.gray);
+      flowZones.reduce(curFlow->getFlow());
+      flow=flowZones.average * multi; ///*~30?
+      gated = false;
+    } else {
+      //the frame the gate opens on has nothing to compare to, the flow starts from the one after
+      if (!gated) {
+        curFlow->reset();
+        flowZones.clear();
+        gated = true;
       }
+      flow = glm::vec2(0, 0);
+    }
+    flow=glm::vec2(flow.x,flow.y) ;
+    dampenedflow+=(flow-dampenedflow)*damp; //~.05
+    prev+=dampenedflow;
 
-      //GUARDING STRATEGIES, when clamp doesn't work. Limit + augmented traction
-      //if to far beyond the limit, additional traction to smoothly take the "cursor" back
-      if(prev.x < -10 ) {
-        prev+=norm*traction*3; //~10
-      }
-      if(prev.x > ofGetWidth()+10) {
-        prev+=norm*traction*3; //~10
-      }
-      if (dampenedflow.x > 1000.) {
-        dampenedflow.x=0.;
-      }
-      if (dampenedflow.x < -1000.) {
-        dampenedflow.x=0.;
-      }
+    glm::vec2 midZone=glm::vec2(ofGetWidth()/2,ofGetHeight()/2);
+    glm::vec2 returnToMid = midZone-prev;
+    glm::vec2 norm = glm::normalize(returnToMid);
+    float dist = glm::distance(prev, midZone);
 
-      int x = ofClamp(prev.x, 0, ofGetWidth());
-      float cursorArea = ofGetWidth()/numShafts;
-
-      //positioning a virtual cursor within the treadling
-      for (int i = 0; i < numShafts; i++) {
-        float cLoc = i * cursorArea;
-        if (x < cursorArea) {
-          cursorX = 0;
-        } else if (x > cLoc && x < cLoc + cursorArea) {
-          cursorX = i;
-        }
-      }
+    prev.x = ofClamp(prev.x, -100, ofGetWidth()+100);
 
-      //non mirrored
-      for (int i = 0; i < numShafts; i++) {
-        float cLoc = i * cursorArea;
-        if (x < cursorArea) {
-          cursorX = 0;
-        } else if (x > cLoc && x < cLoc + cursorArea) {
-          cursorX = i;
-        }
-      }
+    //slight controllable traction/current
+    if(dist > 3) {
+      prev+=norm*(traction);
+    }
 
+    //GUARDING STRATEGIES, when clamp doesn't work. Limit + augmented traction
+    //if to far beyond the limit, additional traction to smoothly take the "cursor" back
+    if(prev.x < -10 ) {
+      prev+=norm*traction*3; //~10
+    }
+    if(prev.x > ofGetWidth()+10) {
+      prev+=norm*traction*3; //~10
+    }
+    if (dampenedflow.x > 1000.) {
+      dampenedflow.x=0.;
+    }
+    if (dampenedflow.x < -1000.) {
+      dampenedflow.x=0.;
+    }
 
+    //positioning a virtual cursor within the treadling, one shaft per equal part of the width
+    float cursorArea = ofGetWidth()/numShafts;
+    cursorX = ofClamp((int)(ofClamp(prev.x, 0, ofGetWidth()) / cursorArea), 0, numShafts - 1);
 
-      //DETECT Y MOTION WITH SMALL LAG, ie counterY > lagNumber
-      if (dampenedflow.y < yThresh && counterY > 30) {   //~-20
-        yMotionNeg = !yMotionNeg;
-        yReset = !yReset;
-        counterY = 0; //RESETTING COUNTER ADDING LAG
-      }
+    //DETECT Y MOTION WITH SMALL LAG, ie counterY > lagNumber
+    if (dampenedflow.y < yThresh && counterY > 30) {   //~-20
+      yMotionNeg = !yMotionNeg;
+      yReset = !yReset;
+      counterY = 0; //RESETTING COUNTER ADDING LAG
+    }
 
-      //RESETS yReset TO USE AS TRIGGER
-      if(counterY > 31) {
-        yReset = 0;
-      }
+    //RESETS yReset TO USE AS TRIGGER
+    if(counterY > 31) {
+      yReset = 0;
+    }
 
-      //DETECT MOTION
-      if (dampenedflow.x < -5. || dampenedflow.x > 5. || dampenedflow.y < -5. || dampenedflow.y > 5.) {
-        motionDetected = true;
-        counterX = 0;
-      } else if (counterX > 200){ //500
-        motionDetected = false;
-      }
+    //DETECT MOTION
+    if (dampenedflow.x < -5. || dampenedflow.x > 5. || dampenedflow.y < -5. || dampenedflow.y > 5.) {
+      motionDetected = true;
+      counterX = 0;
+    } else if (counterX > 200){ //500
+      motionDetected = false;
     }
 
-    //save average movement
+    //save average movement, the last 100 frames
     avrgMove.push_front(prev.x);
     avrgMove.pop_back();
     avrgMove.resize(100);
 
+    //at 60fps the y lag is half a second and motion stays on for 3 seconds after it stops
     counterX++;
     counterY++;
+    framesProcessed++;
+    publish();
+    frameMicros = (frameMicros * 15 + (ofGetElapsedTimeMicros() - frameStart)) / 16;
+  }
+}
+
+//HANDS THE FRAME TO THE APP, the slots are reused so nothing is allocated after the first frames
+void ThreadedCV::publish() {
+  CVResult& r = results.back();
+  r.cursorX = cursorX;
+  r.flow = flow;
+  r.prev = prev;
+  r.dampenedflow = dampenedflow;
+  r.yMotionNeg = yMotionNeg;
+  r.motionDetected = motionDetected;
+  r.yReset = yReset;
+  float avg = 0;
+  for (float m : avrgMove) {
+    avg += m;
+  }
+  r.avgMovement = avrgMove.empty() ? 0 : avg / avrgMove.size();
+  r.zones = flowZones.zones;
+  r.frame = framesProcessed;
+  results.publish();
+
+  if (framesProcessed > 0) {
+    CVVideo& v = videos.back();
+    v.pixels = grayFrame.pixels;
+    curFlow->getFlow().copyTo(v.flow);
+    v.frame = framesProcessed;
+    videos.publish();
   }
 }
 
+//--------------------------------------------------------------
+//APP THREAD
+//the flow backend, taken by the thread at its next frame
+void ThreadedCV::setBackend(int _idx) {
+  backendIdx = ofClamp(_idx, 0, backends.size() - 1);
+}
+
+//the cost of every backend, the one in use marked
+string ThreadedCV::getStats() {
+  stringstream ss;
+  ss << "vision: " << source->getName() << ", " << framesProcessed << " frames, " << frameMicros / 1000.0 << "ms a frame";
+  for (int i = 0; i < backends.size(); i++) {
+    ss << (i == backendIdx ? ", [" : ", ") << backends[i]->getName() << " " << backends[i]->avgMicros / 1000.0 << "ms"
+       << (i == backendIdx ? "]" : "");
+  }
+  ss << ", " << gate.getStats();
+  return ss.str();
+}
+
+//the latest results for this app frame, they stay the same until the next update
+void ThreadedCV::update() {
+  results.acquire();
+}
+
+const CVResult& ThreadedCV::getResult() {
+  return results.front();
+}
+
+//the image and the flow as lines, every 4th pixel. only changes with a new frame
+void ThreadedCV::drawVideo(float _x, float _y, float _w, float _h) {
+  if (videos.acquire()) {
+    const CVVideo& v = videos.front();
+    videoTex.loadData(v.pixels);
+    flowLines.clear();
+    flowLines.setMode(OF_PRIMITIVE_LINES);
+    for (int y = 0; y < v.flow.rows; y += 4) {
+      const cv::Vec2f* row = v.flow.ptr<cv::Vec2f>(y);
+      for (int x = 0; x < v.flow.cols; x += 4) {
+        flowLines.addVertex(glm::vec3(x, y, 0));
+        flowLines.addVertex(glm::vec3(x + row[x][0], y + row[x][1], 0));
+      }
+    }
+  }
+  if (!videoTex.isAllocated()) {
+    return;
+  }
+
+  ofPushMatrix();
+  ofTranslate(_x, _y);
+  ofScale(_w / videoTex.getWidth(), _h / videoTex.getHeight());
+  ofSetColor(255);
+  videoTex.draw(0, 0);
+  ofSetColor(255, 0, 255);
+  flowLines.draw();
+  ofPopMatrix();
+}
+
 void ThreadedCV::draw() {
 
   ofSetColor(255);
   ofPushMatrix();
   //    ofTranslate(250, 100);
   ofScale(0.5, 0.5);
-  decCamera.draw(0,220,640,480);
-  curFlow->draw(0,220,640,480);
+  drawVideo(0,220,640,480);
   //  ofDrawBitmapStringHighlight(ofToString((int) ofGetFrameRate()) + "fps", 10, 20);
 
   ofPopMatrix();
 
   // DRAW DEBUG UI
+  const CVResult& r = getResult();
   ofPushMatrix();
   ofSetColor(255,0,255);
-  ofDrawBitmapStringHighlight("prevX: " + ofToString(prev.x), 0, 0);
-  ofDrawBitmapStringHighlight("prevY: " + ofToString(prev.y), 150, 0);
-  ofDrawBitmapStringHighlight("flowx: " + ofToString(dampenedflow.x), 0, 25);
-  ofDrawBitmapStringHighlight("flowY: " + ofToString(dampenedflow.y), 150, 25);
-  ofDrawBitmapStringHighlight("Y-: " + ofToString(yMotionNeg), 0, 75);
-  ofDrawBitmapStringHighlight("Motion: " + ofToString(motionDetected), 150, 75);
-  ofDrawBitmapStringHighlight("cursorX: " + ofToString(cursorX), 0, 100);
+  ofDrawBitmapStringHighlight("prevX: " + ofToString(r.prev.x), 0, 0);
+  ofDrawBitmapStringHighlight("prevY: " + ofToString(r.prev.y), 150, 0);
+  ofDrawBitmapStringHighlight("flowx: " + ofToString(r.dampenedflow.x), 0, 25);
+  ofDrawBitmapStringHighlight("flowY: " + ofToString(r.dampenedflow.y), 150, 25);
+  ofDrawBitmapStringHighlight("Y-: " + ofToString(r.yMotionNeg), 0, 75);
+  ofDrawBitmapStringHighlight("Motion: " + ofToString(r.motionDetected), 150, 75);
+  ofDrawBitmapStringHighlight("cursorX: " + ofToString(r.cursorX), 0, 100);
 
   //draw cursor position indicator
   ofPushMatrix();
@@ -207,11 +319,11 @@ void ThreadedCV::draw() {
     }
   }
   ofSetColor(0);
-  ofDrawRectangle(cursorX*10, 0, 10, 10);
+  ofDrawRectangle(r.cursorX*10, 0, 10, 10);
 
   //draw cursor flow line
   ofSetColor(0);
-  float testX = ofMap(prev.x, 0, ofGetWidth(), 0, 200);
+  float testX = ofMap(r.prev.x, 0, ofGetWidth(), 0, 200);
   ofSetLineWidth(3);
   ofDrawLine(50,0, 250, 0);
   ofDrawRectangle(testX+50-5, -5, 10, 10);
@@ -227,34 +339,31 @@ void ThreadedCV::calcAvrg() {
 
 ///GETTER FUNCTIONS///
 /////////////////////j
+//from the results of the last update
 int ThreadedCV::getCursor() {
-  return cursorX;
+  return getResult().cursorX;
 }
 
 glm::vec2 ThreadedCV::getDampenedFlow() {
-  return dampenedflow;
+  return getResult().dampenedflow;
 }
 
 bool ThreadedCV::getYmotionNeg() {
-  return yMotionNeg;
+  return getResult().yMotionNeg;
 }
 
 bool ThreadedCV::getYreset() {
-  return yReset;
+  return getResult().yReset;
 }
 
 bool ThreadedCV::getMotionDetected() {
-  return motionDetected;
+  return getResult().motionDetected;
 }
 
 float ThreadedCV::getAvgMovement() {
-  float avg = 0;
-  for (int i = 0; i < avrgMove.size(); i++) {
-    float tempF = avrgMove[i];
-    avg+=tempF;
-  }
-
-  avg = avg/avrgMove.size();
+  return getResult().avgMovement;
+}
 
-  return avg;
+const vector<FlowZone>& ThreadedCV::getZones() {
+  return getResult().zones;
 }
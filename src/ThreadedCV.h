@@ -4,25 +4,53 @@
 #include "ofMain.h"
 #include "ofxOpenCv.h"
 #include "ofxCv.h"
-#include "ofxPS3EyeGrabber.h"
 #include "ofxKinect.h"
+#include "TripleBuffer.h"
+#include "FrameSource.h"
+#include "FlowBackend.h"
+#include "FlowZones.h"
+#include "GrayFrame.h"
+#include "MotionGate.h"
 
 //Namespaces for cleaner code
 using namespace ofxCv;
 using namespace cv;
 //using namespace glm;
 
+//WHAT A FRAME GAVE, published by the thread once per camera frame
+struct CVResult {
+  float cursorX = 0;
+  glm::vec2 flow, prev, dampenedflow;
+  bool yMotionNeg = true, motionDetected = false, yReset = false;
+  float avgMovement = 0;
+  vector<FlowZone> zones; //one per shaft, across the mirrored image
+  uint64_t frame = 0;
+};
+
+//the image the flow was found in and the flow field, for drawing
+struct CVVideo {
+  ofPixels pixels;
+  cv::Mat flow; //CV_32FC2, a vector per pixel
+  uint64_t frame = 0;
+};
+
 class ThreadedCV: public ofThread  {
 
 public:
     ThreadedCV();
     ~ThreadedCV();
 
+    void setSource(unique_ptr<FrameSource> _source);
     void setup(int _numShafts, int _numWarps);
+    void setBackend(int _idx);
+    string getStats();
+    void stop();
     void threadedFunction();
-    void update(float _multi, float _damp, float _yThresh, float _traction);
+    void update();
     void draw();
+    void drawVideo(float _x, float _y, float _w, float _h);
     void calcAvrg();
+    const CVResult& getResult();
 
     int getCursor();
     glm::vec2 getDampenedFlow();
@@ -30,25 +58,43 @@ public:
     bool getYreset();
     bool getMotionDetected();
     float getAvgMovement();
+    const vector<FlowZone>& getZones();
 
 
-    ofVideoGrabber camera;
-    ofxCvColorImage decCamera;
+    unique_ptr<FrameSource> source; //the ps3 eye unless set before setup
 
-    ofxCv::FlowFarneback fb;
-    ofxCv::FlowPyrLK lk;
-    ofxCv::Flow* curFlow;
+    //FLOW, the backend in use changes at the start of a frame
+    vector<unique_ptr<FlowBackend>> backends; //farneback, lk grid, blocks
+    FlowBackend* curFlow;
+    std::atomic<int> backendIdx; //asked for by the app
+    GrayFrame grayFrame; //the decimated, mirrored gray image the flow is found in
+    FlowZones flowZones; //the field per shaft column
+    MotionGate gate; //no flow is found while the room is still
+    bool gated; //the flow was skipped last frame
 
     glm::vec2 flow;
     glm::vec2 dampenedflow;
     glm::vec2 prev;
-    ofxCvColorImage currentColor;
-    ofxCvColorImage decimatedImage;
 
     int numShafts, numWarps;
-    float cursorX, counterY, counterX;
+    float cursorX, counterY, counterX; //counters are in processed frames
     bool yMotionPos, yMotionNeg, motionDetected, yReset;
     float multi, damp, yThresh, traction;
-    vector<float> warpMovements;
     deque<float> avrgMove;
+
+    //CAPTURE, the thread waits here between frames
+    int frameRate; //asked of the source, sets how long a wait is
+    std::mutex frameWaitMutex;
+    std::condition_variable frameWait;
+    std::atomic<uint64_t> framesProcessed, wakeups; //wakeups per frame show how much the thread polls
+    std::atomic<uint64_t> frameMicros; //time from a new frame to its results, averaged
+
+    //SNAPSHOTS, everything above is the threads own, the app only reads these
+    TripleBuffer<CVResult> results; //taken by update, once an app frame
+    TripleBuffer<CVVideo> videos; //taken by drawVideo
+    ofTexture videoTex;
+    ofVboMesh flowLines;
+
+private:
+    void publish();
 };
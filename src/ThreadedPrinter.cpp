@@ -0,0 +1,408 @@
+/*
+ * THREADED THERMAL PRINTER CLASS
+ *
+ * the main thread pushes jobs, the printer thread opens the port, applies the
+ * settings, encodes the jobs to ESC/POS and writes them one by one. nothing in here
+ * is called from the printer thread except threadedFunction/pop/write.
+ *
+ */
+
+#include "ThreadedPrinter.h"
+
+ThreadedPrinter::ThreadedPrinter()
+{
+  baudRate = 19200;
+  overflow = PRINT_COALESCE;
+  reverse = false;
+  bold = false;
+  align = ALIGN_LEFT;
+  heatingDots = 7;
+  heatingTime = 80;
+  heatingInterval = 2;
+  maxCoalesceRows = 256;
+  maxPending = 8;
+  mask = 0;
+  head = 0;
+  tail = 0;
+
+  maxDepth = 0;
+  jobsQueued = 0;
+  jobsPrinted = 0;
+  jobsDropped = 0;
+  jobsCoalesced = 0;
+  lastWriteMicros = 0;
+  maxWriteMicros = 0;
+  avgWriteMicros = 0;
+  lastQueueMicros = 0;
+  lastEncodeMicros = 0;
+  bytesWritten = 0;
+  connected = false;
+}
+
+ThreadedPrinter::~ThreadedPrinter()
+{
+  stop();
+}
+
+void ThreadedPrinter::setup(string _portName, int _queueSize, PrintOverflow _overflow) {
+  portName = _portName;
+  overflow = _overflow;
+
+  //round queue size up to a power of two so indices can be masked
+  size_t capacity = 1;
+  while (capacity < (size_t)max(_queueSize, 1)) {
+    capacity <<= 1;
+  }
+  ring.clear();
+  ring.resize(capacity);
+  mask = capacity - 1;
+  head = 0;
+  tail = 0;
+  pending.clear();
+
+  startThread();
+}
+
+//called every frame from the main thread, pushes the pending coalesced jobs while there is room
+void ThreadedPrinter::update() {
+  while (!pending.empty() && tryPush(pending.front())) {
+    pending.pop_front();
+  }
+}
+
+//flush what is left, give the printer a moment to finish and close down
+void ThreadedPrinter::stop() {
+  if (!isThreadRunning()) {
+    return;
+  }
+
+  uint64_t deadline = ofGetElapsedTimeMillis() + 5000;
+  while ((!pending.empty() || getQueueDepth() > 0) && ofGetElapsedTimeMillis() < deadline) {
+    update();
+    wake.notify_one();
+    ofSleepMillis(5);
+  }
+
+  stopThread();
+  wake.notify_one();
+  waitForThread(false);
+}
+
+//--------------------------------------------------------------
+//SETTINGS
+void ThreadedPrinter::setReverse(bool _reverse) {
+  reverse = _reverse;
+}
+
+void ThreadedPrinter::setBold(bool _bold) {
+  bold = _bold;
+}
+
+void ThreadedPrinter::setAlign(PrintAlign _align) {
+  align = _align;
+}
+
+void ThreadedPrinter::setControlParameter(int _heatingDots, int _heatingTime, int _heatingInterval) {
+  heatingDots = _heatingDots;
+  heatingTime = _heatingTime;
+  heatingInterval = _heatingInterval;
+}
+
+//--------------------------------------------------------------
+//JOBS, main thread only
+bool ThreadedPrinter::print(const ofPixels& _pixels) {
+  PrintJob job;
+  job.type = JOB_IMAGE;
+  job.pixels = _pixels;
+  return push(job);
+}
+
+bool ThreadedPrinter::println(string _text) {
+  PrintJob job;
+  job.type = JOB_TEXT;
+  job.text = _text;
+  return push(job);
+}
+
+//a shed of the draft, every warp printed as dotScale x dotScale dots
+bool ThreadedPrinter::printRow(const vector<int>& _shed, int _dotScale) {
+  return printRows(_shed, (int)_shed.size(), _dotScale);
+}
+
+//a band of sheds one after the other, printed as one raster. _dotScale dots high and
+//_printWidth dots wide, or dotScale dots a warp without a width
+bool ThreadedPrinter::printRows(const vector<int>& _cells, int _numWarps, int _dotScale, int _printWidth) {
+  PrintJob job;
+  job.type = JOB_ROWS;
+  job.cells = _cells;
+  job.numWarps = _numWarps;
+  job.dotScale = _dotScale;
+  job.printWidth = _printWidth;
+  return push(job);
+}
+
+//bytes that are already ESC/POS, sent as they are
+bool ThreadedPrinter::printRaw(const vector<unsigned char>& _bytes) {
+  PrintJob job;
+  job.type = JOB_RAW;
+  job.bytes = _bytes;
+  return push(job);
+}
+
+//the full draft, composited band by band on the printer thread from a copy of the draft
+bool ThreadedPrinter::printDraft(const Draft& _draft) {
+  PrintJob job;
+  job.type = JOB_DRAFT;
+  job.draft = make_shared<DraftSnapshot>();
+  job.draft->copyFrom(_draft);
+  return push(job);
+}
+
+bool ThreadedPrinter::push(PrintJob& _job) {
+  _job.queuedAt = ofGetElapsedTimeMicros();
+  jobsQueued++;
+
+  //keep the order, pending jobs always go before a new one
+  update();
+  if (!pending.empty()) {
+    if (coalesce(pending.back(), _job)) {
+      jobsCoalesced++;
+      return true;
+    }
+    //another type or too high to merge, it waits after the others
+    if ((int)pending.size() < maxPending) {
+      pending.push_back(std::move(_job));
+      return true;
+    }
+    jobsDropped++;
+    ofLogWarning("ThreadedPrinter") << "queue full and " << pending.size() << " jobs pending, dropped";
+    return false;
+  }
+
+  if (tryPush(_job)) {
+    return true;
+  }
+
+  //QUEUE IS FULL
+  if (overflow == PRINT_DROP) {
+    jobsDropped++;
+    return false;
+  } else if (overflow == PRINT_COALESCE) {
+    pending.push_back(std::move(_job));
+    return true;
+  }
+
+  //PRINT_BLOCK, wait for the printer thread to make room
+  while (isThreadRunning()) {
+    if (tryPush(_job)) {
+      return true;
+    }
+    wake.notify_one();
+    ofSleepMillis(1);
+  }
+  jobsDropped++;
+  return false;
+}
+
+bool ThreadedPrinter::tryPush(PrintJob& _job) {
+  if (ring.empty()) {
+    return false;
+  }
+  size_t t = tail.load(memory_order_relaxed);
+  size_t h = head.load(memory_order_acquire);
+  if (t - h > mask) {
+    return false;
+  }
+
+  ring[t & mask] = std::move(_job);
+  tail.store(t + 1, memory_order_release);
+  wake.notify_one();
+
+  int depth = (int)(t + 1 - h);
+  if (depth > maxDepth) {
+    maxDepth = depth;
+  }
+  return true;
+}
+
+//merging a job into the pending one: images and rows are stacked, text lines and bytes appended
+bool ThreadedPrinter::coalesce(PrintJob& _dst, PrintJob& _src) {
+  if (_dst.type != _src.type) {
+    return false;
+  }
+
+  if (_dst.type == JOB_TEXT) {
+    _dst.text += "\n" + _src.text;
+    return true;
+  } else if (_dst.type == JOB_RAW) {
+    _dst.bytes.insert(_dst.bytes.end(), _src.bytes.begin(), _src.bytes.end());
+    return true;
+  } else if (_dst.type == JOB_ROWS) {
+    int rows = (int)(_dst.cells.size() + _src.cells.size()) / max(_dst.numWarps, 1);
+    if (_dst.numWarps != _src.numWarps || _dst.dotScale != _src.dotScale || _dst.printWidth != _src.printWidth
+        || rows * _dst.dotScale > maxCoalesceRows) {
+      return false;
+    }
+    _dst.cells.insert(_dst.cells.end(), _src.cells.begin(), _src.cells.end());
+    return true;
+  } else if (_dst.type != JOB_IMAGE) {
+    return false;
+  }
+
+  ofPixels& a = _dst.pixels;
+  ofPixels& b = _src.pixels;
+  if (a.getWidth() != b.getWidth() || a.getNumChannels() != b.getNumChannels()
+      || a.getHeight() + b.getHeight() > (size_t)maxCoalesceRows) {
+    return false;
+  }
+
+  ofPixels stacked;
+  stacked.allocate(a.getWidth(), a.getHeight() + b.getHeight(), a.getNumChannels());
+  memcpy(stacked.getData(), a.getData(), a.getTotalBytes());
+  memcpy(stacked.getData() + a.getTotalBytes(), b.getData(), b.getTotalBytes());
+  a.swap(stacked);
+  return true;
+}
+
+//--------------------------------------------------------------
+//PRINTER THREAD
+bool ThreadedPrinter::pop(PrintJob& _job) {
+  size_t h = head.load(memory_order_relaxed);
+  size_t t = tail.load(memory_order_acquire);
+  if (h == t) {
+    return false;
+  }
+
+  _job = std::move(ring[h & mask]);
+  ring[h & mask] = PrintJob();
+  head.store(h + 1, memory_order_release);
+  return true;
+}
+
+void ThreadedPrinter::threadedFunction() {
+  connected = serial.setup(portName, baudRate);
+  if (!connected) {
+    ofLogError("ThreadedPrinter") << "could not open printer at " << portName << ", jobs will be discarded";
+  }
+
+  //PRINTER SETTINGS
+  out.clear();
+  escPosInit(out);
+  escPosControlParameter(out, heatingDots, heatingTime, heatingInterval);
+  escPosReverse(out, reverse);
+  escPosBold(out, bold);
+  escPosAlign(out, align);
+  writeBytes(out);
+
+  PrintJob job;
+  while (isThreadRunning()) {
+    if (pop(job)) {
+      write(job);
+    } else {
+      //nothing to do, sleep until a job is pushed (or at most a few ms)
+      std::unique_lock<std::mutex> lck(wakeMutex);
+      wake.wait_for(lck, chrono::milliseconds(5));
+    }
+  }
+
+  //print whatever made it into the queue before stop
+  while (pop(job)) {
+    write(job);
+  }
+  serial.close();
+  connected = false;
+}
+
+void ThreadedPrinter::write(PrintJob& _job) {
+  uint64_t t0 = ofGetElapsedTimeMicros();
+  lastQueueMicros = t0 - _job.queuedAt;
+
+  //ENCODE
+  out.clear();
+  if (_job.type == JOB_IMAGE) {
+    encoder.appendPixels(out, _job.pixels, 127);
+  } else if (_job.type == JOB_TEXT) {
+    escPosText(out, _job.text);
+  } else if (_job.type == JOB_ROWS) {
+    if (_job.dotScale != encoder.dotScale || _job.printWidth != encoder.printWidth) {
+      encoder.setup(encoder.printerDots, _job.dotScale, _job.printWidth);
+    }
+    encoder.appendRows(out, _job.cells.data(), _job.numWarps, (int)_job.cells.size() / max(_job.numWarps, 1));
+  } else if (_job.type == JOB_RAW) {
+    out.swap(_job.bytes);
+  }
+  uint64_t t1 = ofGetElapsedTimeMicros();
+  lastEncodeMicros = t1 - t0;
+
+  //WRITE
+  writeBytes(out);
+
+  //full draft, one band at a time so only one band is ever in memory
+  if (_job.type == JOB_DRAFT && _job.draft) {
+    compositor.begin(*_job.draft);
+    for (int b = 0; b < compositor.getNumBands(); b++) {
+      out.clear();
+      compositor.appendBand(out, b);
+      writeBytes(out);
+    }
+  }
+
+  uint64_t dt = ofGetElapsedTimeMicros() - t1;
+  lastWriteMicros = dt;
+  if (dt > maxWriteMicros) {
+    maxWriteMicros = dt;
+  }
+  //running average over roughly the last 16 writes
+  uint64_t avg = avgWriteMicros;
+  avgWriteMicros = avg == 0 ? dt : avg + ((int64_t)dt - (int64_t)avg) / 16;
+  jobsPrinted++;
+}
+
+//writing everything, the serial port may take only part of it at a time
+void ThreadedPrinter::writeBytes(const vector<unsigned char>& _bytes) {
+  if (!connected) {
+    return;
+  }
+
+  size_t done = 0;
+  while (done < _bytes.size()) {
+    long n = serial.writeBytes(_bytes.data() + done, _bytes.size() - done);
+    if (n < 0) {
+      ofLogError("ThreadedPrinter") << "write to " << portName << " failed";
+      connected = false;
+      return;
+    } else if (n == 0) {
+      ofSleepMillis(1); //printer is busy, wait for the port to drain
+    }
+    done += n;
+    bytesWritten += n;
+  }
+}
+
+//--------------------------------------------------------------
+//COUNTERS
+//every job that went into the queue is written (or discarded) and none is pending
+bool ThreadedPrinter::isIdle() {
+  return pending.empty() && tail.load(memory_order_acquire) == jobsPrinted;
+}
+
+int ThreadedPrinter::getQueueDepth() {
+  return (int)(tail.load(memory_order_acquire) - head.load(memory_order_acquire));
+}
+
+string ThreadedPrinter::getStats() {
+  stringstream ss;
+  ss << "depth " << getQueueDepth() << "/" << ring.size()
+     << " (max " << maxDepth << ")"
+     << " queued " << jobsQueued
+     << " printed " << jobsPrinted
+     << " dropped " << jobsDropped
+     << " coalesced " << jobsCoalesced
+     << " write " << lastWriteMicros / 1000 << "ms"
+     << " avg " << avgWriteMicros / 1000 << "ms"
+     << " max " << maxWriteMicros / 1000 << "ms"
+     << " wait " << lastQueueMicros / 1000 << "ms"
+     << " encode " << lastEncodeMicros << "us"
+     << " bytes " << bytesWritten;
+  return ss.str();
+}
@@ -0,0 +1,130 @@
+/*
+ * THREADED THERMAL PRINTER CLASS
+ *
+ * owns the serial port of the thermal printer and all writes to it on a dedicated thread.
+ * everything is sent as ESC/POS bytes, rows of the draft are encoded straight from
+ * the shed by the RasterEncoder on this thread.
+ * the render loop only pushes print jobs into a bounded lock-free queue
+ * (single producer = main thread, single consumer = printer thread).
+ *
+ * when the queue is full the overflow policy decides what happens:
+ * DROP - the new job is discarded
+ * COALESCE - the new job is merged into the last pending job, the pending jobs are pushed in
+ *            order as soon as there is room. a job that can not be merged is added after them,
+ *            it is only dropped once maxPending jobs are waiting
+ * BLOCK - the main thread waits until there is room
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "RasterEncoder.h"
+#include "DraftCompositor.h"
+
+enum PrintOverflow {
+  PRINT_DROP,
+  PRINT_COALESCE,
+  PRINT_BLOCK
+};
+
+enum PrintAlign {
+  ALIGN_LEFT,
+  ALIGN_MIDDLE,
+  ALIGN_RIGHT
+};
+
+enum PrintJobType {
+  JOB_NONE,
+  JOB_IMAGE,
+  JOB_TEXT,
+  JOB_ROWS,
+  JOB_RAW,
+  JOB_DRAFT
+};
+
+struct PrintJob {
+  PrintJobType type = JOB_NONE;
+  ofPixels pixels;
+  string text;
+  vector<int> cells; //JOB_ROWS, sheds one after the other
+  int numWarps = 0;
+  int dotScale = 1;
+  int printWidth = 0; //dots across a row, 0 = numWarps * dotScale
+  vector<unsigned char> bytes; //JOB_RAW
+  shared_ptr<DraftSnapshot> draft; //JOB_DRAFT
+  uint64_t queuedAt = 0; //micros, used for queue latency
+};
+
+class ThreadedPrinter: public ofThread {
+
+public:
+    ThreadedPrinter();
+    ~ThreadedPrinter();
+
+    void setup(string _portName, int _queueSize, PrintOverflow _overflow);
+    void update();
+    void stop();
+    void threadedFunction();
+
+    //PRINTER SETTINGS, applied by the printer thread when the port is opened
+    void setReverse(bool _reverse);
+    void setBold(bool _bold);
+    void setAlign(PrintAlign _align);
+    void setControlParameter(int _heatingDots, int _heatingTime, int _heatingInterval);
+
+    //JOBS
+    bool print(const ofPixels& _pixels);
+    bool println(string _text);
+    bool printRow(const vector<int>& _shed, int _dotScale);
+    bool printRows(const vector<int>& _cells, int _numWarps, int _dotScale, int _printWidth = 0);
+    bool printRaw(const vector<unsigned char>& _bytes);
+    bool printDraft(const Draft& _draft);
+
+    //COUNTERS
+    int getQueueDepth();
+    bool isIdle(); //everything pushed has been written, main thread
+    string getStats();
+
+    string portName;
+    int baudRate;
+    PrintOverflow overflow;
+    bool reverse, bold;
+    PrintAlign align;
+    int heatingDots, heatingTime, heatingInterval;
+    int maxCoalesceRows; //cap on the height of a coalesced image job
+    int maxPending; //cap on the jobs waiting for room under COALESCE
+
+    //counters, written by either thread, read by anyone
+    atomic<int> maxDepth;
+    atomic<uint64_t> jobsQueued, jobsPrinted, jobsDropped, jobsCoalesced;
+    atomic<uint64_t> lastWriteMicros, maxWriteMicros, avgWriteMicros, lastQueueMicros;
+    atomic<uint64_t> lastEncodeMicros, bytesWritten;
+    atomic<bool> connected;
+
+private:
+    bool push(PrintJob& _job);
+    bool tryPush(PrintJob& _job);
+    bool pop(PrintJob& _job);
+    bool coalesce(PrintJob& _dst, PrintJob& _src);
+    void write(PrintJob& _job);
+    void writeBytes(const vector<unsigned char>& _bytes);
+
+    //RING BUFFER, capacity is a power of two, head/tail run freely and are masked on access
+    vector<PrintJob> ring;
+    size_t mask;
+    atomic<size_t> head; //next job to print, only advanced by the printer thread
+    atomic<size_t> tail; //next free slot, only advanced by the main thread
+
+    //pending coalesced jobs in print order, only touched by the main thread
+    deque<PrintJob> pending;
+
+    //wake up for the printer thread
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    //printer thread only
+    ofSerial serial;
+    RasterEncoder encoder;
+    DraftCompositor compositor;
+    vector<unsigned char> out;
+};
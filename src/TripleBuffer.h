@@ -0,0 +1,60 @@
+/*
+ * TRIPLE BUFFER
+ *
+ * hands whole values from one writer thread to one reader thread without locks.
+ * the writer fills back() and publishes it, the reader takes the latest published
+ * value with acquire() and reads front() until it acquires again. neither side
+ * ever waits, the writer can publish many times between two reads and the reader
+ * only sees the last one, always complete.
+ *
+ * three slots: the one the writer fills, the one the reader holds and the last
+ * published one in the middle. publish and acquire swap a slot with the middle.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+template<class T>
+class TripleBuffer {
+
+public:
+    TripleBuffer() {
+      backSlot = 0;
+      middle = 1;
+      frontSlot = 2;
+    }
+
+    //WRITER
+    T& back() {
+      return slots[backSlot];
+    }
+
+    //the back slot becomes the latest, the writer gets the old middle to fill next
+    void publish() {
+      backSlot = middle.exchange(backSlot | freshBit, std::memory_order_acq_rel) & slotMask;
+    }
+
+    //READER
+    //true if something new was published since the last acquire
+    bool acquire() {
+      if (!(middle.load(std::memory_order_acquire) & freshBit)) {
+        return false;
+      }
+      frontSlot = middle.exchange(frontSlot, std::memory_order_acq_rel) & slotMask;
+      return true;
+    }
+
+    const T& front() const {
+      return slots[frontSlot];
+    }
+
+private:
+    static const int freshBit = 4;
+    static const int slotMask = 3;
+
+    T slots[3];
+    int backSlot; //writer only
+    std::atomic<int> middle; //slot index, freshBit set when published and not acquired yet
+    int frontSlot; //reader only
+};
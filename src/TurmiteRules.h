@@ -0,0 +1,127 @@
+/*
+ * TURMITE RULES
+ *
+ * what an ent does on a cell, as a table: cell colour x ent state -> moves,
+ * colour written, next state. the moves of an entry are a string read left to
+ * right, '+' turns clockwise, '-' counter clockwise, 'U' turns around and 'F'
+ * steps forward, so langtons ant is "+F" on white and "-F" on black.
+ *
+ * every entry is worked out for all four directions at setup, a step is then one
+ * lookup: the new direction, the cells moved and what is written. the number of
+ * colours is a template parameter so the entries of a state are a fixed stride.
+ *
+ * REFERENCE:
+ * https://en.wikipedia.org/wiki/Turmite
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+template<int Colours>
+class TurmiteRules {
+
+public:
+    //one entry for one direction
+    struct Step {
+      int8_t dCol, dRow;
+      uint8_t dir, write;
+      int next;
+    };
+
+    //an entry as it was set, kept to make the mirrored table
+    struct Rule {
+      string moves;
+      int write, next;
+    };
+
+    TurmiteRules() {
+      setup(1);
+    }
+
+    //every state does nothing and keeps the colour until set
+    void setup(int _numStates) {
+      numStates = max(_numStates, 1);
+      rules.assign(numStates * Colours, Rule{"", 0, 0});
+      steps.assign(numStates * Colours * 4, Step{0, 0, 0, 0, 0});
+      for (int s = 0; s < numStates; s++) {
+        for (int c = 0; c < Colours; c++) {
+          set(s, c, "", c, s);
+        }
+      }
+    }
+
+    void set(int _state, int _colour, string _moves, int _write, int _next) {
+      int e = _state * Colours + _colour;
+      rules[e] = Rule{_moves, _write, _next};
+      for (int d = 0; d < 4; d++) {
+        int dir = d;
+        int dCol = 0;
+        int dRow = 0;
+        for (char m : _moves) {
+          switch (m) {
+          case '+':
+            dir = (dir + 1) % 4;
+            break;
+          case '-':
+            dir = (dir + 3) % 4;
+            break;
+          case 'U':
+            dir = (dir + 2) % 4;
+            break;
+          case 'F':
+            //0 = north, 1 = east, 2 = south, 3 = west
+            dCol += dir == 1 ? 1 : dir == 3 ? -1 : 0;
+            dRow += dir == 2 ? 1 : dir == 0 ? -1 : 0;
+            break;
+          default:
+            break;
+          }
+        }
+        steps[e * 4 + d] = Step{(int8_t)dCol, (int8_t)dRow, (uint8_t)dir, (uint8_t)_write, _next};
+      }
+    }
+
+    //states past the table act like state 0
+    const Step& get(int _state, int _colour, int _dir) const {
+      int s = (unsigned)_state < (unsigned)numStates ? _state : 0;
+      return steps[(s * Colours + _colour) * 4 + _dir];
+    }
+
+    //the same rules with every turn the other way
+    TurmiteRules mirrored() const {
+      TurmiteRules m;
+      m.setup(numStates);
+      for (int s = 0; s < numStates; s++) {
+        for (int c = 0; c < Colours; c++) {
+          Rule r = rules[s * Colours + c];
+          for (char& ch : r.moves) {
+            ch = ch == '+' ? '-' : ch == '-' ? '+' : ch;
+          }
+          m.set(s, c, r.moves, r.write, r.next);
+        }
+      }
+      return m;
+    }
+
+    int numStates;
+    vector<Rule> rules; //state * Colours + colour
+    vector<Step> steps; //(state * Colours + colour) * 4 + dir
+};
+
+//THE FOUR RULES THE ENTS ALWAYS HAD, the state is the rule and never changes
+//on a set cell it turns one way, on a clear cell the other, and flips the cell
+inline TurmiteRules<2> entRules() {
+  TurmiteRules<2> r;
+  r.setup(4);
+  r.set(0, 1, "-F", 0, 0);
+  r.set(0, 0, "+F", 1, 0);
+  //a step and a turn back, or two steps turning the same way
+  r.set(1, 1, "-F+F", 0, 1);
+  r.set(1, 0, "+F+F", 1, 1);
+  r.set(2, 1, "-F", 0, 2);
+  r.set(2, 0, "FF", 1, 2);
+  r.set(3, 1, "F", 0, 3);
+  r.set(3, 0, "F", 1, 3);
+  return r;
+}
@@ -0,0 +1,453 @@
+/*
+ * VIRTUAL THERMAL PRINTER
+ *
+ * parses the commands the app (ThreadedPrinter) sends:
+ * ESC @, ESC 7, ESC E, ESC a, ESC J, ESC d, GS B, DC2 *, GS v 0 and plain text + LF.
+ * text is not rasterised with a font, every character becomes a filled 12x24 block,
+ * enough to see where and how much was printed.
+ *
+ */
+
+#include "VirtualPrinter.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+VirtualPrinter::VirtualPrinter()
+{
+  printerDots = 384;
+  bytesPerLine = printerDots / 8;
+  bufferSize = 4096;
+  timeScale = 1.0;
+  minLineMicros = 2000; //about 60mm/s at 8 dots/mm
+  heatingDots = 7;
+  heatingTime = 80;
+  heatingInterval = 2;
+
+  master = -1;
+  slave = -1;
+  rasterLines = 0;
+  rasterBytes = 0;
+  headFree = 0;
+  startMicros = 0;
+
+  bytesReceived = 0;
+  linesPrinted = 0;
+  commandsParsed = 0;
+  unknownBytes = 0;
+  bufferHighWater = 0;
+  bufferFullCount = 0;
+  modelMicros = 0;
+  bufferLevel = 0;
+  bandsExpected = 0;
+  bandsMatched = 0;
+  bandsMismatched = 0;
+  checkLine = 0;
+  scanLine = 0;
+  linesAtCheck = 0;
+}
+
+VirtualPrinter::~VirtualPrinter()
+{
+  stop();
+}
+
+//OPEN THE PSEUDO-TERMINAL
+bool VirtualPrinter::setup(int _printerDots, int _bufferSize, float _timeScale) {
+  printerDots = _printerDots;
+  bytesPerLine = printerDots / 8;
+  bufferSize = _bufferSize;
+  timeScale = _timeScale;
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    ofLogError("VirtualPrinter") << "could not open a pseudo-terminal";
+    return false;
+  }
+  portName = ptsname(master);
+
+  //keeping the slave open ourselves so the master never sees a hang up,
+  //and making it raw so the bytes come through untouched
+  slave = open(portName.c_str(), O_RDWR | O_NOCTTY);
+  if (slave >= 0) {
+    termios options;
+    tcgetattr(slave, &options);
+    cfmakeraw(&options);
+    tcsetattr(slave, TCSANOW, &options);
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+  ofLogNotice("VirtualPrinter") << "virtual printer at " << portName;
+  startThread();
+  return true;
+}
+
+void VirtualPrinter::stop() {
+  if (isThreadRunning()) {
+    stopThread();
+    waitForThread(false);
+  }
+  if (slave >= 0) {
+    close(slave);
+    slave = -1;
+  }
+  if (master >= 0) {
+    close(master);
+    master = -1;
+  }
+}
+
+string VirtualPrinter::getPortName() {
+  return portName;
+}
+
+//--------------------------------------------------------------
+void VirtualPrinter::threadedFunction() {
+  startMicros = ofGetElapsedTimeMicros();
+  headFree = 0;
+  unsigned char tmp[1024];
+  bool wasFull = false;
+
+  while (isThreadRunning()) {
+    //PRINT, as far as the head and the buffer allow
+    bool progressed = false;
+    while (parse()) {
+      progressed = true;
+    }
+
+    //READ INTO THE DEVICE BUFFER, only when there is room in it
+    int room = bufferSize - (int)buffer.size();
+    if (room > 0) {
+      wasFull = false;
+      pollfd p;
+      p.fd = master;
+      p.events = POLLIN;
+      p.revents = 0;
+      if (poll(&p, 1, progressed ? 0 : 2) > 0 && (p.revents & POLLIN)) {
+        ssize_t n = read(master, tmp, min(room, (int)sizeof(tmp)));
+        if (n > 0) {
+          buffer.insert(buffer.end(), tmp, tmp + n);
+          bytesReceived += n;
+          if (buffer.size() > bufferHighWater) {
+            bufferHighWater = buffer.size();
+          }
+        }
+      }
+    } else {
+      //buffer full, the pty fills up behind it and the writer gets back-pressure
+      if (!wasFull) {
+        bufferFullCount++;
+        wasFull = true;
+      }
+      if (!progressed) {
+        ofSleepMillis(1);
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------
+//TAKES ONE COMMAND (OR ONE RASTER LINE) FROM THE BUFFER, false if it has to wait
+bool VirtualPrinter::parse() {
+  bufferLevel = (int)buffer.size();
+
+  //print head still busy with the last line
+  if (timeScale > 0 && ofGetElapsedTimeMicros() - startMicros < headFree) {
+    return false;
+  }
+
+  //RASTER IN PROGRESS, one line at a time
+  if (rasterLines > 0) {
+    if ((int)buffer.size() < rasterBytes) {
+      return false;
+    }
+    line.assign(buffer.begin(), buffer.begin() + rasterBytes);
+    buffer.erase(buffer.begin(), buffer.begin() + rasterBytes);
+    printLine(line.data(), rasterBytes);
+    rasterLines--;
+    return true;
+  }
+
+  if (buffer.empty()) {
+    return false;
+  }
+
+  size_t size = buffer.size();
+  unsigned char b = buffer[0];
+  size_t used = 1;
+
+  if (b == 27) {
+    //ESC
+    if (size < 2) return false;
+    unsigned char c = buffer[1];
+    if (c == 64) {
+      //ESC @, reset
+      heatingDots = 7;
+      heatingTime = 80;
+      heatingInterval = 2;
+      used = 2;
+    } else if (c == 55) {
+      //ESC 7 n1 n2 n3, heating dots, time and interval
+      if (size < 5) return false;
+      heatingDots = buffer[2];
+      heatingTime = buffer[3];
+      heatingInterval = buffer[4];
+      used = 5;
+    } else if (c == 74 || c == 100) {
+      //ESC J n feed dots, ESC d n feed text lines
+      if (size < 3) return false;
+      flushText();
+      feed(c == 74 ? buffer[2] : buffer[2] * 30);
+      used = 3;
+    } else if (c == 69 || c == 97 || c == 33 || c == 45 || c == 51 || c == 71 || c == 123) {
+      //ESC E/a/!/-/3/G/{ n, settings that do not change the dots here
+      if (size < 3) return false;
+      used = 3;
+    } else {
+      unknownBytes++;
+      used = 2;
+    }
+  } else if (b == 29) {
+    //GS
+    if (size < 2) return false;
+    unsigned char c = buffer[1];
+    if (c == 118) {
+      //GS v 0 m xL xH yL yH, raster of yL+yH*256 lines of xL+xH*256 bytes
+      if (size < 8) return false;
+      rasterBytes = buffer[4] + buffer[5] * 256;
+      rasterLines = buffer[6] + buffer[7] * 256;
+      flushText();
+      used = 8;
+    } else {
+      //GS B n and other settings with one argument
+      if (size < 3) return false;
+      used = 3;
+    }
+  } else if (b == 18) {
+    //DC2
+    if (size < 2) return false;
+    unsigned char c = buffer[1];
+    if (c == 42) {
+      //DC2 * r n, raster of r lines of n bytes
+      if (size < 4) return false;
+      rasterLines = buffer[2];
+      rasterBytes = buffer[3];
+      flushText();
+      used = 4;
+    } else {
+      //DC2 # n and friends
+      if (size < 3) return false;
+      used = 3;
+    }
+  } else if (b == 10) {
+    //LF, prints the text line (or feeds one line if there is none)
+    if (text.empty()) {
+      feed(30);
+    } else {
+      flushText();
+    }
+  } else if (b >= 32) {
+    text += (char)b;
+  } else {
+    unknownBytes++;
+  }
+
+  buffer.erase(buffer.begin(), buffer.begin() + used);
+  commandsParsed++;
+  return true;
+}
+
+//--------------------------------------------------------------
+//PRINTING ONE DOT LINE, the time it takes depends on how many dots are heated at once
+void VirtualPrinter::printLine(const unsigned char* _line, int _numBytes) {
+  int n = min(_numBytes, bytesPerLine);
+  int black = 0;
+  for (int i = 0; i < n; i++) {
+    unsigned char v = _line[i];
+    while (v) {
+      black += v & 1;
+      v >>= 1;
+    }
+  }
+
+  int dotsPerStrobe = (heatingDots + 1) * 8;
+  int strobes = max(1, (black + dotsPerStrobe - 1) / dotsPerStrobe);
+  uint64_t lineMicros = max(minLineMicros, strobes * heatingTime * 10 + heatingInterval * 10);
+
+  uint64_t now = ofGetElapsedTimeMicros() - startMicros;
+  headFree = max(headFree, now) + (uint64_t)(lineMicros * timeScale);
+  modelMicros += lineMicros;
+
+  stripMutex.lock();
+  size_t start = strip.size();
+  strip.resize(start + bytesPerLine, 0);
+  memcpy(strip.data() + start, _line, n);
+  stripMutex.unlock();
+  linesPrinted++;
+}
+
+void VirtualPrinter::feed(int _numLines) {
+  vector<unsigned char> blank(bytesPerLine, 0);
+  for (int i = 0; i < _numLines; i++) {
+    printLine(blank.data(), bytesPerLine);
+  }
+}
+
+//TEXT AS BLOCKS, font A is 12x24 dots, 30 dots line spacing
+void VirtualPrinter::flushText() {
+  if (text.empty()) {
+    return;
+  }
+  vector<unsigned char> glyphs(bytesPerLine, 0);
+  for (int c = 0; c < (int)text.size() && (c + 1) * 12 <= printerDots; c++) {
+    if (text[c] == ' ') {
+      continue;
+    }
+    for (int x = c * 12 + 1; x < c * 12 + 11; x++) {
+      glyphs[x >> 3] |= (unsigned char)(0x80 >> (x & 7));
+    }
+  }
+  for (int y = 0; y < 24; y++) {
+    bool ink = y >= 4 && y < 20;
+    if (ink) {
+      printLine(glyphs.data(), bytesPerLine);
+    } else {
+      feed(1);
+    }
+  }
+  feed(6);
+  text.clear();
+}
+
+//--------------------------------------------------------------
+//OUTPUT
+int VirtualPrinter::getNumLines() {
+  std::lock_guard<std::mutex> lck(stripMutex);
+  return (int)(strip.size() / max(bytesPerLine, 1));
+}
+
+//saving the strip as a png, black dots black
+bool VirtualPrinter::saveStrip(string _path) {
+  ofPixels pixels;
+  {
+    std::lock_guard<std::mutex> lck(stripMutex);
+    int h = (int)(strip.size() / max(bytesPerLine, 1));
+    if (h == 0) {
+      return false;
+    }
+    pixels.allocate(printerDots, h, OF_IMAGE_GRAYSCALE);
+    unsigned char* dst = pixels.getData();
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < printerDots; x++) {
+        bool dot = strip[y * bytesPerLine + (x >> 3)] & (0x80 >> (x & 7));
+        dst[y * printerDots + x] = dot ? 0 : 255;
+      }
+    }
+  }
+  return ofSaveImage(pixels, _path);
+}
+
+//checks if the dot lines from _line on are the shed as the encoder would print it
+bool VirtualPrinter::shedMatches(int _line, const int* _shed, int _numWarps, int _dotScale, int _printWidth) {
+  if (_dotScale != encoder.dotScale || _printWidth != encoder.printWidth || printerDots != encoder.printerDots) {
+    encoder.setup(printerDots, _dotScale, _printWidth);
+  }
+  const vector<unsigned char>& want = encoder.encodeLine(_shed, _numWarps);
+
+  if (_line < 0 || (size_t)(_line + _dotScale) * bytesPerLine > strip.size()) {
+    return false;
+  }
+  //a blank shed is sent as a feed, an empty line
+  for (int l = _line; l < _line + _dotScale; l++) {
+    const unsigned char* got = strip.data() + l * bytesPerLine;
+    for (int i = 0; i < bytesPerLine; i++) {
+      if (got[i] != (i < (int)want.size() ? want[i] : 0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//--------------------------------------------------------------
+//CHECKING PRINTED BANDS
+void VirtualPrinter::expectRows(const vector<int>& _cells, int _numWarps, int _dotScale, int _printWidth) {
+  if (_numWarps <= 0 || _cells.empty()) {
+    return;
+  }
+  expected.push_back(ExpectedBand{_cells, _numWarps, max(_dotScale, 1), _printWidth});
+  bandsExpected++;
+}
+
+//nothing waiting in the device buffer or in the pty
+bool VirtualPrinter::isIdle() {
+  int waiting = 0;
+  if (master >= 0 && ioctl(master, FIONREAD, &waiting) != 0) {
+    waiting = 0;
+  }
+  return bufferLevel == 0 && waiting == 0;
+}
+
+//every band is looked for from the end of the last one found, text and images can be
+//in between. a band that is not found by the time the sender and the device have
+//been idle for a whole check is counted as a mismatch and taken to fill the lines
+//after the last one. each call only tries the starts the lines printed since allow
+void VirtualPrinter::checkBands(bool _senderIdle) {
+  uint64_t lines = linesPrinted;
+  bool idle = _senderIdle && isIdle() && lines == linesAtCheck;
+  linesAtCheck = lines;
+
+  std::lock_guard<std::mutex> lck(stripMutex);
+  int numLines = (int)(strip.size() / max(bytesPerLine, 1));
+  while (!expected.empty()) {
+    const ExpectedBand& band = expected.front();
+    int rows = (int)band.cells.size() / band.numWarps;
+    int bandLines = rows * band.dotScale;
+
+    int found = -1;
+    int start = max(checkLine, scanLine);
+    for (; start + bandLines <= numLines && found < 0; start++) {
+      bool same = true;
+      for (int r = 0; r < rows && same; r++) {
+        same = shedMatches(start + r * band.dotScale, band.cells.data() + r * band.numWarps, band.numWarps, band.dotScale, band.printWidth);
+      }
+      if (same) {
+        found = start;
+      }
+    }
+
+    if (found >= 0) {
+      bandsMatched++;
+      checkLine = found + bandLines;
+    } else if (idle) {
+      bandsMismatched++;
+      checkLine = min(checkLine + bandLines, numLines);
+      ofLogWarning("VirtualPrinter") << "a band of " << rows << " rows is not in the printed strip";
+    } else {
+      //not printed yet, the next call goes on from here
+      scanLine = start;
+      break;
+    }
+    scanLine = checkLine;
+    expected.pop_front();
+  }
+}
+
+string VirtualPrinter::getStats() {
+  uint64_t wall = ofGetElapsedTimeMicros() - startMicros;
+  uint64_t model = modelMicros;
+  stringstream ss;
+  ss << "virtual " << portName
+     << " lines " << linesPrinted
+     << " bytes " << bytesReceived
+     << " buffer " << bufferLevel << "/" << bufferSize
+     << " (max " << bufferHighWater << ", full " << bufferFullCount << "x)"
+     << " device " << (model > 0 ? linesPrinted * 1000000 / model : 0) << " lines/s"
+     << " actual " << (wall > 0 ? linesPrinted * 1000000 / wall : 0) << " lines/s"
+     << " heat " << heatingDots << "," << heatingTime << "," << heatingInterval
+     << " bands " << bandsMatched << "/" << bandsExpected << " match, " << bandsMismatched << " mismatched";
+  return ss.str();
+}
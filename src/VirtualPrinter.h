@@ -0,0 +1,92 @@
+/*
+ * VIRTUAL THERMAL PRINTER
+ *
+ * a stand-in for the thermal printer when it is not connected.
+ * opens a pseudo-terminal, the app writes to the slave side as if it was /dev/ttyUSB0
+ * and this thread reads the master side, parses the ESC/POS stream and prints it
+ * into a strip of dot lines that can be saved as a png.
+ *
+ * the speed of the real device is modelled from the heat settings (ESC 7):
+ * a dot line takes one heating strobe per (heatingDots+1)*8 black dots of heatingTime*10us,
+ * plus the heating interval, and never less than the paper motor needs.
+ * bytes are only taken out of the input buffer at that speed, so when the buffer is
+ * full the pty fills up and writes on the other side start to block, like the real thing.
+ *
+ * bands of rows the app prints can be announced with expectRows. checkBands then looks
+ * for each of them in the strip, in order, as the encoder would print it, and counts
+ * the ones that are not there once everything sent has been printed.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+#include "RasterEncoder.h"
+
+class VirtualPrinter: public ofThread {
+
+public:
+    VirtualPrinter();
+    ~VirtualPrinter();
+
+    bool setup(int _printerDots, int _bufferSize, float _timeScale);
+    void stop();
+    void threadedFunction();
+
+    string getPortName();
+    bool saveStrip(string _path);
+    int getNumLines();
+    string getStats();
+
+    //CHECKING PRINTED BANDS, from the app thread
+    void expectRows(const vector<int>& _cells, int _numWarps, int _dotScale, int _printWidth = 0);
+    void checkBands(bool _senderIdle);
+
+    int printerDots, bytesPerLine;
+    int bufferSize; //size of the input buffer of the device in bytes
+    float timeScale; //1 = real speed, 0 = as fast as possible
+    int minLineMicros; //paper motor limit per dot line
+    int heatingDots, heatingTime, heatingInterval;
+
+    //counters
+    atomic<uint64_t> bytesReceived, linesPrinted, commandsParsed, unknownBytes;
+    atomic<uint64_t> bufferHighWater, bufferFullCount, modelMicros;
+    atomic<int> bufferLevel;
+    uint64_t startMicros;
+    uint64_t bandsExpected, bandsMatched, bandsMismatched; //app thread only
+
+private:
+    bool parse();
+    void printLine(const unsigned char* _line, int _numBytes);
+    void feed(int _numLines);
+    void flushText();
+    bool shedMatches(int _line, const int* _shed, int _numWarps, int _dotScale, int _printWidth); //strip locked
+    bool isIdle();
+
+    struct ExpectedBand {
+      vector<int> cells;
+      int numWarps, dotScale, printWidth;
+    };
+    deque<ExpectedBand> expected;
+    int checkLine; //bands before this line are checked
+    int scanLine; //the first band is not at any start before this line
+    uint64_t linesAtCheck; //lines printed at the last checkBands
+
+    int master, slave;
+    string portName;
+
+    //INPUT BUFFER OF THE DEVICE
+    deque<unsigned char> buffer;
+
+    //raster command in progress
+    int rasterLines, rasterBytes;
+    string text;
+
+    //PRINTED STRIP, packed 1 bit per dot like the raster data
+    std::mutex stripMutex;
+    vector<unsigned char> strip;
+    vector<unsigned char> line;
+
+    //time the print head is free again, in virtual micros since start
+    uint64_t headFree;
+    RasterEncoder encoder;
+};
@@ -0,0 +1,99 @@
+/*
+ * POOL OF WORKER THREADS
+ */
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool()
+{
+  task = nullptr;
+  numTasks = 0;
+  nextTask = 0;
+  busy = 0;
+  generation = 0;
+  quit = false;
+}
+
+WorkerPool::~WorkerPool()
+{
+  stop();
+}
+
+void WorkerPool::setup(int _numThreads) {
+  stop();
+  quit = false;
+  for (int i = 1; i < max(_numThreads, 1); i++) {
+    threads.push_back(std::thread(&WorkerPool::work, this, generation));
+  }
+}
+
+void WorkerPool::stop() {
+  {
+    std::unique_lock<std::mutex> lock(runMutex);
+    quit = true;
+  }
+  wake.notify_all();
+  for (auto& t : threads) {
+    t.join();
+  }
+  threads.clear();
+}
+
+//RUNS _task(0) .. _task(_numTasks-1), returns when all are done
+void WorkerPool::run(int _numTasks, const function<void(int)>& _task) {
+  if (threads.empty() || _numTasks < 2) {
+    for (int i = 0; i < _numTasks; i++) {
+      _task(i);
+    }
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(runMutex);
+    task = &_task;
+    numTasks = _numTasks;
+    nextTask = 0;
+    busy = (int)threads.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  takeTasks();
+
+  std::unique_lock<std::mutex> lock(runMutex);
+  done.wait(lock, [this]{ return busy == 0; });
+  task = nullptr;
+}
+
+int WorkerPool::size() {
+  return (int)threads.size() + 1;
+}
+
+//--------------------------------------------------------------
+//_seen is the run count at start, so a new worker does not take an old run
+void WorkerPool::work(uint64_t _seen) {
+  uint64_t seen = _seen;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(runMutex);
+      wake.wait(lock, [&]{ return quit || generation != seen; });
+      if (quit) {
+        return;
+      }
+      seen = generation;
+    }
+
+    takeTasks();
+
+    std::unique_lock<std::mutex> lock(runMutex);
+    if (--busy == 0) {
+      done.notify_one();
+    }
+  }
+}
+
+void WorkerPool::takeTasks() {
+  for (int i = nextTask++; i < numTasks; i = nextTask++) {
+    (*task)(i);
+  }
+}
@@ -0,0 +1,40 @@
+/*
+ * POOL OF WORKER THREADS
+ *
+ * a fixed set of threads started once and kept waiting, run() hands them a
+ * number of tasks and returns when all are done. the calling thread works too,
+ * so a pool of n threads starts n-1 of its own.
+ *
+ * tasks are taken in any order by whichever thread is free, the results must not
+ * depend on which thread runs what.
+ *
+ */
+
+#pragma once
+#include "ofMain.h"
+
+class WorkerPool {
+
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    void setup(int _numThreads);
+    void stop();
+    void run(int _numTasks, const function<void(int)>& _task);
+    int size();
+
+private:
+    void work(uint64_t _seen);
+    void takeTasks();
+
+    vector<std::thread> threads;
+    std::mutex runMutex;
+    std::condition_variable wake, done;
+    const function<void(int)>* task;
+    int numTasks;
+    std::atomic<int> nextTask;
+    int busy; //workers still on the current run
+    uint64_t generation; //runs started, workers wake up when it changes
+    bool quit;
+};
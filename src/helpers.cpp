@@ -1,11 +1,16 @@
 #include "helpers.h"
 
 //////CONVERT VECTOR OF INTS TO STRING//////
+//single digits are written straight into the string, no stream needed
 string vectorToString(vector<int> tempVec) {
-        stringstream ss;
-        copy( tempVec.begin(), tempVec.end(), ostream_iterator<int>(ss)); //mod
-        string currentString = ss.str();
-        currentString = currentString.substr(0, currentString.length());  // get rid of the trailing space
+        string currentString;
+        currentString.reserve(tempVec.size());
+        for (int v : tempVec) {
+                if (v >= 0 && v < 10) {
+                        currentString += (char)('0' + v);
+                } else {
+                        currentString += to_string(v);
+                }
+        }
         return currentString;
 }
-
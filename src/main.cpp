@@ -1,13 +1,54 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "ofAppNoWindow.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
+    //OPTIONS
+    //--headless           no window and no gl, the views are drawn by the SoftRasterizer
+    //                     and the last frame is saved to bin/data/raster.png on exit
+    //--synthetic          moving blobs instead of the camera
+    //--video <path>       a video file or a folder of images instead of the camera
+    //--offline            synthetic or video frames as fast as they can be processed
+    //--bench              runs the benchmarks (key B) without a window and exits
+    ofApp* app = new ofApp();
+    bool bench = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--headless") {
+            app->headless = true;
+        } else if (arg == "--synthetic") {
+            app->cvSource = "synthetic";
+        } else if (arg == "--video" && i + 1 < argc) {
+            app->cvSource = "video";
+            app->cvPath = argv[++i];
+        } else if (arg == "--offline") {
+            app->cvRealtime = false;
+        } else if (arg == "--bench") {
+            bench = true;
+        }
+    }
+
+    if (bench) {
+        ofAppNoWindow window;
+        ofSetupOpenGL(&window, 800, 480, OF_WINDOW);
+        runBenchmarks(5);
+        delete app;
+        return 0;
+    }
+
+    if (app->headless) {
+        ofAppNoWindow window;
+        ofSetupOpenGL(&window, 800, 480, OF_WINDOW);
+        ofRunApp(app);
+        return 0;
+    }
+
     ofSetupOpenGL(800,480,OF_FULLSCREEN);			// <-------- setup the GL context
 
     // this kicks off the running of my app
     // can be OF_WINDOW or OF_FULLSCREEN
     // pass in width and height too:
-    ofRunApp(new ofApp());
+    ofRunApp(app);
 
 }
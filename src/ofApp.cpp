@@ -27,7 +27,6 @@
 DEPENDENCIES:
 'ofxGui',
 'ofxOpenCv',
-'ofxThermalPrinter
 'ofxCv',
 'ofxPS3EyeGrabber',
 'ofxKinect',
@@ -47,6 +46,8 @@ void ofApp::setup(){
   fg = ofColor(0); //foreground colour draft
 
   print = true; //check if to print with thermal printer
+  printText = false; //print rows as text instead of raster
+  mirrorText = false; //mirror printed rows as text in the terminal
   runDraft = true; //run/pause update
 
   numShafts = 5; //number of shafts
@@ -67,47 +68,112 @@ void ofApp::setup(){
   displayMode = 0;
   session = false; //false = flow/interactive, true = print
   movementFieldMax = 20; //max of the slow interaction/influence of the entity system
+  preEvolveSteps = 10000; //ticks the ent system runs before the first frame
+  idleSteps = 1; //ticks per update while no motion is detected
 
   cellSize = width / (numWarps+numShafts + numBoxPad); //size of cells in draft
 
   //TYPOGRAPHY
-  txt.load("verdana.ttf", 8, true, true);
-  txt.setLineHeight(18.0f);
-  txt.setLetterSpacing(1.037);
+  if (!headless) {
+    txt.load("verdana.ttf", 8, true, true);
+    txt.setLineHeight(18.0f);
+    txt.setLetterSpacing(1.037);
+  }
 
   //SETUP PRINTER
   setupPrinter();
+  draft.useGL = !headless;
   draft.setup(numShafts, numWarps, orgX, orgY, width, height, numBoxPad, cellSize, bg, fg);
+  //FRAMES FOR THE VISION, the camera unless main asked for another source
+  if (cvSource == "synthetic") {
+    tCV.setSource(unique_ptr<FrameSource>(new SyntheticSource()));
+  } else if (cvSource == "video") {
+    tCV.setSource(unique_ptr<FrameSource>(new VideoSource(cvPath)));
+  }
+  if (tCV.source) {
+    tCV.source->realtime = cvRealtime;
+  }
   tCV.setup(numShafts, numWarps);
 
 
   //SETUP ENTSYSTEM
+  entSys.useGL = !headless;
   entSys.setup(100, 800/100, numShafts, 0, 0, 800, 480);
+  entSys.stepN(preEvolveSteps);
 
   //MOVEMENT FIELD ARRAY, number of counters
   movementFieldArr.resize(numShafts);
 
   //SETUP PATTERN FBO
-  patternFbo.allocate(800, 480);
-  patternFbo.begin();
-  ofClear(0);
-  patternFbo.end();
+  if (!headless) {
+    patternFbo.allocate(800, 480);
+    patternFbo.begin();
+    ofClear(0);
+    patternFbo.end();
+  }
+
+  //SETUP SCENE FBO, redrawn only when something changed
+  redraw = true;
+  fpsText = "0fps";
+  fpsMillis = 0;
+  sceneRenders = 0;
+  uiRenders = 0;
+  if (!headless) {
+    sceneFbo.allocate(ofGetWidth(), ofGetHeight(), GL_RGB);
+  }
+
+  //SETUP CPU RENDERING, always on when headless
+  useRaster = headless;
+  rasterMode = displayMode;
+  raster.setup(ofGetWidth(), ofGetHeight(), !headless);
 
 }
 
 // EXIT FUNCTION TO CLOSE DOWN PRINTER AND OPTIONALLY PRINT EMPTY LINE
 void ofApp::exit(){
   //    printer.println("\n"); //UNCOMMENT TO ADD EXTRA EMPTY SPACE WHEN EXIT
-  printer.close();
+  printBand(); //rows still waiting in the band
+  printTextRows();
+  printer.stop(); //flushes the print queue and closes the port
+  printerPool.stop();
+  if (headless) {
+    raster.save("raster.png"); //last frame
+  }
+  if (useVirtualPrinter) {
+    ofSleepMillis(500); //let the virtual printer take the last bytes
+    cout << virtualPrinter.getStats() << endl;
+    virtualPrinter.saveStrip("virtualPrint.png");
+    virtualPrinter.stop();
+  }
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
+  //what the camera thread found last, the same for the whole frame
+  tCV.update();
+
   //UPDATERATE CAP TO AVOID CRASHES
   if(updateRate < 1) {
     updateRate = 1;
   }
 
+  //fps text once a second, not every frame
+  if (ofGetElapsedTimeMillis() - fpsMillis >= 1000) {
+    fpsMillis = ofGetElapsedTimeMillis();
+    fpsText = ofToString((int)ofGetFrameRate()) + "fps";
+  }
+
+  //hand pending print jobs to the printer threads
+  if (band.isDue()) {
+    printBand();
+  }
+  printer.update();
+  printerPool.update();
+  //the bands printed so far checked against the rows they were made from
+  if (useVirtualPrinter) {
+    virtualPrinter.checkBands(printer.isIdle());
+  }
+
   if (session == false) {
     //update with optical flow and camera interaction
     flowSession();
@@ -121,6 +187,41 @@ void ofApp::update(){
 
 //--------------------------------------------------------------
 void ofApp::draw(){
+  //CPU RENDERING, the whole view as one texture
+  if (useRaster) {
+    drawRaster();
+    if (headless) {
+      return;
+    }
+    raster.draw(0, 0);
+  } else {
+    //the scene is only drawn again when the simulation ticked, else the last one is shown
+    if (redraw) {
+      sceneFbo.begin();
+      ofClear(0, 255);
+      drawScene();
+      sceneFbo.end();
+      redraw = false;
+      sceneRenders++;
+    }
+    ofSetColor(255);
+    sceneFbo.draw(0, 0);
+  }
+  if (displayMode == 3) {
+    drawUICached(800,500, 800, 435);
+  }
+
+  //quick FPS UI
+  if (displayGui) {
+    ofSetColor(0);
+    ofDrawBitmapStringHighlight(fpsText, 20, 20);
+    ofDrawBitmapStringHighlight("Rate" + ofToString(updateRate), 20, 40);
+  }
+}
+
+//--------------------------------------------------------------
+//the views of the current display mode, drawn into the scene fbo
+void ofApp::drawScene(){
   ofSetColor(0);
   ofFill();
   ofDrawRectangle(0,0, 800, 480);
@@ -139,56 +240,146 @@ void ofApp::draw(){
     ofTranslate(800, 0);
     entSys.display();
     ofPopMatrix();
-    drawUI(800,500, 800, 435);
   }
 
-  //quick FPS UI
-  if (displayGui) {
-    ofSetColor(0);
-    ofDrawBitmapStringHighlight(ofToString((int) ofGetFrameRate()) + "fps"    , 20, 20);
-    ofDrawBitmapStringHighlight("Rate" + ofToString(updateRate), 20, 40);
-  }
 }
 
 //--------------------------------------------------------------
+//same views as draw, painted on the cpu, only what changed since last frame
+void ofApp::drawRaster(){
+  if (displayMode != rasterMode) {
+    raster.invalidate();
+    rasterMode = displayMode;
+  }
+
+  if(displayMode == 0) {
+    raster.drawDraft(draft, 0, 0);
+  } else if(displayMode == 1) {
+    raster.drawPattern(draft, 0, 0, 800);
+  } else if(displayMode == 2){
+    raster.drawEnts(entSys, 0, 0);
+  } else if(displayMode == 3) {
+    raster.drawDraft(draft, 0, 0);
+    raster.drawPattern(draft, 0, 500, 800);
+    raster.drawEnts(entSys, 800, 0);
+  }
+  raster.upload();
 
+}
 
 //--------------------------------------------------------------
 //set up thermal printer
 void ofApp::setupPrinter(){
-  //PRINTER SEETTINGS
-  printer.open("/dev/ttyUSB0");
+  //PRINTER SEETTINGS, applied by the printer thread when the port is open
   printer.setReverse(false);
   printer.setBold(true);
-  printer.setAlign(MIDDLE);
+  printer.setAlign(ALIGN_MIDDLE);
   printer.setControlParameter(7,160,0);
+  //no printer connected, print to a virtual one on a pseudo-terminal instead
+  string portName = "/dev/ttyUSB0";
+  useVirtualPrinter = false;
+  if (!ofFile::doesFileExist(portName, false)) {
+    useVirtualPrinter = virtualPrinter.setup(384, 4096, 1.0);
+    if (useVirtualPrinter) {
+      ofLogWarning("ofApp") << portName << " not found, printing to a virtual printer at " << virtualPrinter.getPortName();
+      portName = virtualPrinter.getPortName();
+    } else {
+      ofLogError("ofApp") << portName << " not found and no virtual printer, nothing will be printed";
+    }
+  }
+  //queue of 8 jobs, rows are stacked into one job if the printer falls behind
+  printer.setup(portName, 8, PRINT_COALESCE);
+
+  //rows are printed in bands of 16, or whatever there is after 1.5 seconds
+  band.setup(16, 1500);
+  //text rows in batches of 16, 32 characters fit on a line of the printer
+  printerText.setup(numWarps, 16, 32, GLYPHS_CP437);
+  terminalText.setup(numWarps, 16, 0, GLYPHS_UTF8);
+
+  //additional printers, if there is a data/printers.txt
+  if (printerPool.setupFromFile("printers.txt")) {
+    cout << "printer pool of " << printerPool.size() << " printers" << endl;
+  }
 
 }
 //--------------------------------------------------------------
-//print line with thermal printer
+//print line with thermal printer, queued for the printer thread
 void ofApp::printString(string inputString){
   printer.println(inputString);
 
 }
 //--------------------------------------------------------------
-//print image with thermalPrinter
+//print image with thermalPrinter, queued for the printer thread
 void ofApp::printImg(ofImage inputImg){
-  printer.print(inputImg);
+  printer.print(inputImg.getPixels());
+
+}
+//--------------------------------------------------------------
+//print current shed with thermalPrinter, collected into a band (or a batch of text rows) first
+void ofApp::printRow(vector<int> inputShed){
+  bool textFull = false;
+  if (printText) {
+    textFull = printerText.add(inputShed);
+  } else {
+    //the warps changed, the rows so far go out as a band of their own
+    if (!band.fits(inputShed)) {
+      printBand();
+    }
+    if (band.add(inputShed)) {
+      printBand();
+    }
+  }
+  if (mirrorText) {
+    textFull = terminalText.add(inputShed) || textFull;
+  }
+  if (textFull) {
+    printTextRows();
+  }
+
+}
+//--------------------------------------------------------------
+//write the text rows formatted so far, one write per batch
+void ofApp::printTextRows(){
+  if (!printerText.isEmpty()) {
+    const char* data = printerText.getData();
+    printer.printRaw(vector<unsigned char>(data, data + printerText.getLength()));
+    printerText.clear();
+  }
+  if (!terminalText.isEmpty()) {
+    cout.write(terminalText.getData(), terminalText.getLength());
+    cout.flush();
+    terminalText.clear();
+  }
+
+}
+//--------------------------------------------------------------
+//print the rows collected so far as one raster, encoded on the printer threads
+void ofApp::printBand(){
+  if (band.isEmpty()) {
+    return;
+  }
+  //as wide as the row fbo used to be, printSize is fractional so warps are 7 or 8 dots
+  bool queued = printer.printRows(band.cells, band.numWarps, (int)draft.printSize, (int)draft.printWidth);
+  printerPool.printRows(band.cells, band.numWarps);
+  //a dropped band is never printed, only the queued ones are looked for
+  if (useVirtualPrinter && queued) {
+    virtualPrinter.expectRows(band.cells, band.numWarps, (int)draft.printSize, (int)draft.printWidth);
+  }
+  band.clear();
 
 }
 //--------------------------------------------------------------
 //print fullDraft with thermalPrinter
+//the printer thread composites a copy of the draft in bands, no need to pause the update
 void ofApp::printFullDraft(){
-  runDraft = false;  //pausing the update
   draft.setupDrawDown(); //calculating the full pattern (ie with the same threading)
-  printImg(draft.draftToImg()); //printing full draft
+  printer.printDraft(draft); //printing full draft
   print = false;  //stopping the printing
-
-  runDraft = true; //resuming the draft
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
+  redraw = true; //most keys change what is on screen
   if (key == '1') { draft.setupTieUpSimple();}
   if (key == '2') { draft.setupTieUpPlex();}
   if (key == '3') { draft.setupTieUpTwill();}
@@ -217,6 +408,27 @@ void ofApp::keyPressed(int key){
   }
   if (key == 'b'){
     entSys.setup(100, 800/100, numShafts, 0, 0, 800, 480);
+    entSys.stepN(preEvolveSteps);
+  }
+  if (key == 'e'){
+    //1, 4, 16 ... 4096 and back to 1
+    idleSteps = idleSteps >= 4096 ? 1 : idleSteps * 4;
+  }
+  if (key == 'f'){
+    //next optical flow backend
+    tCV.setBackend((tCV.backendIdx + 1) % tCV.backends.size());
+    cout << tCV.getStats() << endl;
+  }
+  if (key == 'g'){
+    //flow on every frame or only when something moves
+    tCV.gate.enabled = !tCV.gate.enabled;
+    cout << tCV.gate.getStats() << endl;
+  }
+  if (key == 'U'){
+    //ents walk off the screen into a world without edges, or back to the wrapping grid
+    entSys.unbounded = !entSys.unbounded;
+    entSys.setup(100, 800/100, numShafts, 0, 0, 800, 480);
+    entSys.stepN(preEvolveSteps);
   }
   if (key == 'm'){
     entSys.morph = true;
@@ -236,6 +448,8 @@ void ofApp::keyPressed(int key){
     }
   }
   if (key == 's'){
+    printBand(); //rows of the old session go out on their own
+    printTextRows();
     session = !session;
   }
   if (key == 'u'){
@@ -253,6 +467,44 @@ void ofApp::keyPressed(int key){
     print = !print;
     cout << print << endl;
   }
+  if (key == 't'){
+    printTextRows();
+    printText = !printText;
+  }
+  if (key == 'T'){
+    printTextRows();
+    mirrorText = !mirrorText;
+  }
+  if (key == 'B'){
+    runBenchmarks(numShafts);
+  }
+  if (key == 'R'){
+    useRaster = !useRaster;
+    raster.invalidate();
+  }
+  if (key == 'q'){
+    cout << printer.getStats() << endl;
+    cout << draft.renderer.getStats() << endl;
+    cout << raster.getStats() << endl;
+    if (entSys.unbounded) {
+      cout << entSys.world.getStats() << endl;
+    }
+    cout << "ents: " << entSys.texelsPatched << " texels patched, tick " << entSys.tick << ", " << idleSteps << " ticks per idle update" << endl;
+    cout << "camera: " << tCV.framesProcessed.load() << " frames, " << tCV.wakeups.load() / max(tCV.framesProcessed.load(), (uint64_t)1) << " wakeups/frame" << endl;
+    cout << tCV.getStats() << endl;
+    cout << "redraws: " << sceneRenders << " scene, " << uiRenders << " ui in " << ofGetFrameNum() << " frames" << endl;
+    cout << "text rows: " << printerText.getNanosPerRow() << "ns/row printer, " << terminalText.getNanosPerRow() << "ns/row terminal, " << printerText.rowsRefused + terminalText.rowsRefused << " refused" << endl;
+    if (useVirtualPrinter) {
+      cout << virtualPrinter.getStats() << endl;
+    }
+    cout << printerPool.getStats();
+  }
+  if (key == 'v' && useVirtualPrinter){
+    virtualPrinter.saveStrip("virtualPrint.png");
+  }
+  if (key == 'F'){
+    printFullDraft();
+  }
 }
 
 
@@ -275,8 +527,13 @@ void ofApp::flowSession() {
 
   //updating the drafts
   if (runDraft && ofGetFrameNum() % updateRate == 0 ) {
-    //ENT SYSTEM
-    entSys.update(tCV.getCursor());
+    redraw = true; //the simulation ticks, the scene changes
+    //ENT SYSTEM, evolves faster while nobody is moving, the draft gets what most ticks wrote
+    if (tCV.getMotionDetected() || idleSteps <= 1) {
+      entSys.update(tCV.getCursor());
+    } else {
+      entSys.stepN(idleSteps);
+    }
 
     //update threading if movement not detected by pushing states from entSystem
     if (tCV.getMotionDetected() == false) {
@@ -312,14 +569,14 @@ void ofApp::flowSession() {
       //            AND PRINT
       if(print && ofGetFrameNum() % 13 == 0) {
         ofColor(255);
-        printImg(draft.getCurrentImg());
+        printRow(draft.shed);
       }
     }
     //          update all of the draft
     draft.update();
 
     //changing updateMode when movement in y-axis is detected
-    if (tCV.yReset) {
+    if (tCV.getYreset()) {
       if(updateMode < 4) {
         updateMode++;
       } else {
@@ -340,6 +597,7 @@ void ofApp::flowSession() {
 //Session for print experiments. Very modular.
 void ofApp::printSession() {
   if (runDraft && ofGetFrameNum() % updateRate == 0) {
+    redraw = true; //the simulation ticks, the scene changes
     //ENT SYSTEM
     entSys.update(tCV.getCursor());
     if (ofRandom(1)>0.98){
@@ -370,7 +628,7 @@ void ofApp::printSession() {
     }
     if(print) {
       ofColor(255);
-      printImg(draft.getCurrentImg());
+      printRow(draft.shed);
       //      printFullDraft();
     }
 
@@ -386,6 +644,7 @@ void ofApp::printSession() {
 //session for repeat patterns
 void ofApp::repeatSession() {
   if (runDraft && ofGetFrameNum() % updateRate == 0) {
+    redraw = true; //the simulation ticks, the scene changes
     if (flipCounter < 50) {
       draft.updateWarp = false;
       draft.updateWeft = false;
@@ -404,7 +663,7 @@ void ofApp::repeatSession() {
 
     if(print) {
       ofColor(255);
-      printImg(draft.getCurrentImg());
+      printRow(draft.shed);
     }
 
     if (flipCounter > 200) {
@@ -418,18 +677,77 @@ void ofApp::repeatSession() {
 //--------------------------------------------------------------
 //calculating accumulated movements in the room, changing the rules for the enteties
 void ofApp::fieldMovement() {
-  int idx = tCV.cursorX;
-  if(tCV.motionDetected && idx < movementFieldArr.size()) {
-    if( movementFieldArr[tCV.cursorX] > movementFieldMax) {
-      movementFieldArr[tCV.cursorX] = 0.0;
-      entSys.randomIndividRule(tCV.cursorX);
-      draft.updateTieUpRand(tCV.cursorX);
+  int idx = tCV.getCursor();
+  if(tCV.getMotionDetected() && idx < movementFieldArr.size()) {
+    if( movementFieldArr[idx] > movementFieldMax) {
+      movementFieldArr[idx] = 0.0;
+      entSys.randomIndividRule(idx);
+      draft.updateTieUpRand(idx);
+      redraw = true;
     } else {
-      movementFieldArr[tCV.cursorX]+=0.1;
+      movementFieldArr[idx]+=0.1;
     }
   }
 }
 
+//--------------------------------------------------------------
+//the ui text and meters are drawn into a layer only when one of their values changed
+void ofApp::drawUICached(int _x, int _y, int _w, int _h) {
+  getUIValues(uiKey);
+  if (uiKey != uiValues) {
+    if (uiFbo.getWidth() != _w || uiFbo.getHeight() != _h) {
+      uiFbo.allocate(_w, _h, GL_RGB);
+    }
+    uiFbo.begin();
+    ofClear(0, 255);
+    ofPushMatrix();
+    ofTranslate(-_x, -_y);
+    drawUI(_x, _y, _w, _h);
+    ofPopMatrix();
+    uiFbo.end();
+    uiValues.swap(uiKey);
+    uiRenders++;
+  }
+  ofSetColor(255);
+  uiFbo.draw(_x, _y);
+
+  //camera and flow change every frame, drawn live on top
+  drawUIVideo(_x, _y);
+}
+
+//everything drawUI shows as it is shown, to tell if the layer is out of date. the
+//flow and the cursor are rounded like their text, noise under a tenth of a pixel
+//does not redraw it. refills _values, no allocation once it has its size
+static float shownUI(float _v) {
+  return roundf(_v * 10) / 10;
+}
+
+void ofApp::getUIValues(vector<float>& _values) {
+  const CVResult& cv = tCV.getResult();
+  _values = {
+    (float)(fpsMillis / 1000 % 100000), (float)updateRate, (float)runDraft, (float)updateMode, (float)displayMode, (float)session,
+    (float)printer.getQueueDepth(), (float)printer.maxDepth.load(), (float)printer.jobsDropped.load(),
+    (float)printer.jobsCoalesced.load(), (float)(printer.lastWriteMicros / 1000), (float)(printer.avgWriteMicros / 1000),
+    (float)cv.cursorX, shownUI(cv.prev.x), shownUI(cv.prev.y), shownUI(cv.dampenedflow.x), shownUI(cv.dampenedflow.y),
+    (float)cv.yMotionNeg, (float)cv.motionDetected,
+    (float)entSys.numEnts, (float)entSys.morph, movementFieldMax
+  };
+  for (int i = 0; i < entSys.numEnts; i++) {
+    _values.push_back(entSys.entArr[i].state);
+  }
+  _values.insert(_values.end(), movementFieldArr.begin(), movementFieldArr.end());
+}
+
+//camera + curflow
+void ofApp::drawUIVideo(int _x, int _y) {
+  int off = 15;
+  ofPushMatrix();
+  ofTranslate(_x+(27*off), _y+(15*off));
+  ofScale(0.4, 0.4);
+  tCV.drawVideo(0,0,640,480);
+  ofPopMatrix();
+}
+
 //--------------------------------------------------------------
 void ofApp::drawUI(int _x, int _y, int _w, int _h) {
   int xR = _x;
@@ -444,22 +762,27 @@ void ofApp::drawUI(int _x, int _y, int _w, int _h) {
   //    TYPO
   ofSetColor(255);
   txt.drawString("::Draft Settings::", xR+off, yR+(1*off));
-  txt.drawString(ofToString((int)ofGetFrameRate()) + "fps", xR+off, yR+(2*off));
+  txt.drawString(fpsText, xR+off, yR+(2*off));
   txt.drawString("Update Rate: " + ofToString(updateRate), xR+off, yR+(3*off));
   txt.drawString("Run Draft [r]: " + ofToString(runDraft), xR+off, yR+(4*off));
   txt.drawString("Mode [z]: " + ofToString(updateMode), xR+off, yR+(5*off));
   txt.drawString("Display [x]: " + ofToString(displayMode), xR+off, yR+(6*off));
   txt.drawString("Session [s]: " + ofToString(session), xR+off, yR+(7*off));
 
+  txt.drawString("::Printer::", xR+off, yR+(9*off));
+  txt.drawString("Queue: " + ofToString(printer.getQueueDepth()) + " (max " + ofToString(printer.maxDepth.load()) + ")", xR+off, yR+(10*off));
+  txt.drawString("Dropped: " + ofToString(printer.jobsDropped.load()) + " Coalesced: " + ofToString(printer.jobsCoalesced.load()), xR+off, yR+(11*off));
+  txt.drawString("Write: " + ofToString(printer.lastWriteMicros / 1000) + "ms avg " + ofToString(printer.avgWriteMicros / 1000) + "ms", xR+off, yR+(12*off));
+
 
   txt.drawString("::Optical Flow::", xR+off, yR+(15*off));
-  txt.drawString("cursorX: " + ofToString(tCV.cursorX), xR+off, yR+(17*off));
-  txt.drawString("prevX: " + ofToString(tCV.prev.x), xR+off, yR+(18*off));
-  txt.drawString("prevY: " + ofToString(tCV.prev.y), xR+off, yR+(19*off));
-  txt.drawString("flowx: " + ofToString(tCV.dampenedflow.x), xR+off, yR+(20*off));
-  txt.drawString("flowY: " + ofToString(tCV.dampenedflow.y), xR+off, yR+(21*off));
-  txt.drawString("Y-: " + ofToString(tCV.yMotionNeg), xR+off, yR+(22*off));
-  txt.drawString("Motion detected: " + ofToString(tCV.motionDetected), xR+off, yR+(23*off));
+  txt.drawString("cursorX: " + ofToString(tCV.getResult().cursorX), xR+off, yR+(17*off));
+  txt.drawString("prevX: " + ofToString(tCV.getResult().prev.x, 1), xR+off, yR+(18*off));
+  txt.drawString("prevY: " + ofToString(tCV.getResult().prev.y, 1), xR+off, yR+(19*off));
+  txt.drawString("flowx: " + ofToString(tCV.getResult().dampenedflow.x, 1), xR+off, yR+(20*off));
+  txt.drawString("flowY: " + ofToString(tCV.getResult().dampenedflow.y, 1), xR+off, yR+(21*off));
+  txt.drawString("Y-: " + ofToString(tCV.getResult().yMotionNeg), xR+off, yR+(22*off));
+  txt.drawString("Motion detected: " + ofToString(tCV.getResult().motionDetected), xR+off, yR+(23*off));
 
   // FLOW/CURSOR visualizer
   ofPushMatrix();
@@ -474,24 +797,16 @@ void ofApp::drawUI(int _x, int _y, int _w, int _h) {
     }
   }
   ofSetColor(0);
-  ofDrawRectangle(tCV.cursorX*10, 0, 10, 10);
+  ofDrawRectangle(tCV.getResult().cursorX*10, 0, 10, 10);
 
   //draw cursor flow line
   ofSetColor(255);
-  float testX = ofMap(tCV.prev.x, 0, ofGetWidth(), 0, 200);
+  float testX = ofMap(tCV.getResult().prev.x, 0, ofGetWidth(), 0, 200);
   ofSetLineWidth(3);
   ofDrawLine(50,0, 250, 0);
   ofDrawRectangle(testX+50-5, -5, 10, 10);
   ofPopMatrix();
 
-  // draw camera+ curflow
-  ofPushMatrix();
-  ofTranslate(xR+(27*off), yR+(15*off));
-  ofScale(0.4, 0.4);
-  tCV.decCamera.draw(0,0,640,480);
-  tCV.curFlow->draw(0,0,640,480);
-  ofPopMatrix();
-
   //ENTYSTEM
   ofSetColor(255);
   txt.drawString("::Ent System::", xR+(27 *off), yR+(1*off));
@@ -565,7 +880,11 @@ void ofApp::mouseExited(int x, int y){
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h){
-
+  if (!headless) {
+    sceneFbo.allocate(w, h, GL_RGB);
+    raster.setup(w, h, true);
+  }
+  redraw = true;
 }
 
 //--------------------------------------------------------------
@@ -7,9 +7,15 @@
 //#include "OpticalFlow.h"
 #include "ThreadedCV.h"
 #include "EntSystem.h"
+#include "ThreadedPrinter.h"
+#include "VirtualPrinter.h"
+#include "PrinterPool.h"
+#include "BandAggregator.h"
+#include "RowFormatter.h"
+#include "SoftRasterizer.h"
+#include "Bench.h"
 
 //addons
-#include "ofxThermalPrinter.h"
 #include "ofxOpenCv.h"
 /*
  * WYRD
@@ -40,7 +46,6 @@
 DEPENDENCIES:
 'ofxGui',
 'ofxOpenCv',
-'ofxThermalPrinter
 'ofxCv',
 'ofxPS3EyeGrabber',
 'ofxKinect',
@@ -59,12 +64,20 @@ public:
   void setupPrinter();
   void printString(string inputString);
   void printImg(ofImage inputImg);
+  void printRow(vector<int> inputShed);
+  void printBand();
+  void printTextRows();
   void printFullDraft();
   void printSession();
   void flowSession();
   void repeatSession();
   void fieldMovement();
   void drawUI(int _x, int _y, int _w, int _h);
+  void drawRaster();
+  void drawScene();
+  void drawUICached(int _x, int _y, int _w, int _h);
+  void drawUIVideo(int _x, int _y);
+  void getUIValues(vector<float>& _values);
 
   void keyPressed(int key);
   void keyReleased(int key);
@@ -81,8 +94,9 @@ public:
   //VARIABLES
   int numWarps, numShafts, numWeft, offsetX, offsetY, updateRate, flipCounter, morphCounter;
   int entStatesTotal;
+  int preEvolveSteps, idleSteps;
   float orgX, orgY, width, height, wWidth, wHeight, tWidth, tHeight, cellSize, numBoxPad, cellPad, updateCounter, movementFieldMax;
-  bool print, runDraft, displayGui, session;
+  bool print, runDraft, displayGui, session, printText, mirrorText;
   int updateMode, displayMode;
   vector<float> movementFieldArr;
   ofTrueTypeFont txt;
@@ -92,13 +106,35 @@ public:
 
   ofFbo patternFbo;
 
+  //REDRAW ONLY ON CHANGE, the scene and the ui text are kept in fbos
+  ofFbo sceneFbo, uiFbo;
+  bool redraw; //the simulation ticked or something in the scene changed
+  vector<float> uiValues; //values the ui layer was last drawn with
+  vector<float> uiKey; //this frames values, refilled
+  string fpsText; //updated once a second
+  uint64_t fpsMillis, sceneRenders, uiRenders;
+
+  //CPU RENDERING, for headless runs or without a usable gpu
+  SoftRasterizer raster;
+  bool useRaster;
+  bool headless = false; //set in main, no window and no gl at all
+  string cvSource = "camera"; //set in main, camera, synthetic or video
+  string cvPath; //the video file or image folder
+  bool cvRealtime = true; //false runs synthetic and video frames as fast as they go
+  int rasterMode; //display mode the raster was painted for
+
   //OBJECTS
   Draft draft;
   ThreadedCV tCV;
   EntSystem entSys;
 
   //PRINTER
-  ofxThermalPrinter printer;
+  ThreadedPrinter printer;
+  VirtualPrinter virtualPrinter; //stand-in when no printer is connected
+  bool useVirtualPrinter;
+  PrinterPool printerPool; //more printers, each with its own view of the draft, from data/printers.txt
+  BandAggregator band; //rows waiting to be printed as one raster
+  RowFormatter printerText, terminalText; //rows as text, for the printer in text mode and the terminal
 
 
 